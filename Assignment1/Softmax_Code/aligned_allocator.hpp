@@ -0,0 +1,68 @@
+#ifndef ALIGNED_ALLOCATOR_HPP
+#define ALIGNED_ALLOCATOR_HPP
+
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <sys/mman.h>
+
+// Alignment of the buffers, one cache line (and two AVX vectors)
+static const size_t BUFFER_ALIGNMENT = 64;
+
+// Size of a transparent huge page
+static const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+// If true, buffers of at least HUGE_PAGE_SIZE bytes are aligned to a huge
+// page and the kernel is asked to back them with transparent huge pages.
+// inline: a single flag shared by all the translation units
+inline bool use_huge_pages = false;
+
+// Allocator for std::vector returning 64-byte aligned memory, optionally
+// backed by 2MB transparent huge pages (madvise(MADV_HUGEPAGE)), which
+// removes most of the TLB misses when streaming over very large vectors.
+template <typename T>
+struct AlignedAllocator {
+	using value_type = T;
+
+	AlignedAllocator() noexcept = default;
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U> &) noexcept {}
+
+	T *allocate(size_t n) {
+		size_t bytes = n * sizeof(T);
+		bool huge = use_huge_pages && bytes >= HUGE_PAGE_SIZE;
+		size_t alignment = huge ? HUGE_PAGE_SIZE : BUFFER_ALIGNMENT;
+
+		// aligned_alloc wants a size multiple of the alignment
+		bytes = (bytes + alignment - 1) / alignment * alignment;
+		void *p = std::aligned_alloc(alignment, bytes);
+		if (!p) {
+			throw std::bad_alloc();
+		}
+		if (huge) {
+			// Only a hint: without THP support the memory is still usable
+			madvise(p, bytes, MADV_HUGEPAGE);
+		}
+		return static_cast<T *>(p);
+	}
+
+	void deallocate(T *p, size_t) noexcept {
+		std::free(p);
+	}
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T> &, const AlignedAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T> &, const AlignedAllocator<U> &) { return false; }
+
+template <typename T>
+using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+// True if p is aligned to a multiple of alignment bytes
+inline bool is_aligned(const void *p, size_t alignment) {
+	return (uintptr_t)p % alignment == 0;
+}
+
+#endif // ALIGNED_ALLOCATOR_HPP
@@ -0,0 +1,232 @@
+#ifndef ATTENTION_AVX_HPP
+#define ATTENTION_AVX_HPP
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <softmax_avx.hpp>
+
+// Scaled dot-product attention O = softmax(Q K^T / sqrt(d)) V, single head.
+// Q is [N x d], K is [M x d], V is [M x dv] and O is [N x dv], all row-major
+// and contiguous.
+// attention_naive_avx materializes the [N x M] score matrix: a matmul, a
+// softmax_avx per row and a second matmul.
+// attention_flash_avx never stores more than a [ATTN_BR x ATTN_BC] tile of
+// scores: for a block of ATTN_BR queries it streams over blocks of ATTN_BC
+// keys and keeps, for every query, the running maximum m, the running sum l
+// of exp(s - m) and the unnormalized output acc. When a block raises the
+// maximum, l and acc are rescaled by exp(m_old - m_new) (online softmax), and
+// at the end acc is divided by l. The K/V block is reused by the ATTN_BR
+// queries while it is in cache.
+// Both transpose K once (d x M, rows padded to a multiple of 8), so that the
+// scores of 8 keys are computed with vertical multiply-adds, without
+// horizontal sums.
+
+#ifndef ATTN_BR
+#define ATTN_BR 16
+#endif
+#ifndef ATTN_BC
+#define ATTN_BC 128
+#endif
+static_assert(ATTN_BC % 8 == 0, "ATTN_BC must be a multiple of 8");
+
+// Runs fn(begin, end) on num_threads contiguous blocks of [0, n) with
+// granularity grain; the calling thread works on the first block
+template <typename F>
+inline void parallel_blocks(size_t n, size_t grain, int num_threads, F fn) {
+	size_t units = SDIV(n, grain);
+	num_threads = (int)std::min<size_t>(std::max(num_threads, 1), std::max<size_t>(units, 1));
+	size_t block = SDIV(units, (size_t)num_threads) * grain;
+	std::vector<std::thread> threads;
+	for (int t = 1; t < num_threads; ++t) {
+		threads.emplace_back(fn, std::min(n, t * block), std::min(n, (t + 1) * block));
+	}
+	fn(0, std::min(n, block));
+	for (auto &t : threads) {
+		t.join();
+	}
+}
+
+// Kt[k * ldk + j] = K[j * d + k], the padding columns j >= M are zero
+inline aligned_vector<float> transpose_keys(const float *K, size_t M, size_t d, size_t ldk) {
+	aligned_vector<float> Kt(d * ldk, 0.0f);
+	for (size_t j = 0; j < M; ++j) {
+		for (size_t k = 0; k < d; ++k) {
+			Kt[k * ldk + j] = K[j * d + k];
+		}
+	}
+	return Kt;
+}
+
+// s[j] = scale * dot(q, K_j) for the n8 (multiple of 8) keys whose
+// transposed columns start at Kt, with leading dimension ldk. 32 keys at a
+// time, so that the four accumulators hide the latency of the additions and
+// each broadcast of q[k] is used four times.
+inline void scores_avx(const float *q, const float *Kt, size_t ldk, size_t n8, size_t d, float scale, float *s) {
+	const __m256 scale_vec = _mm256_set1_ps(scale);
+	size_t j = 0;
+	for (; j + 32 <= n8; j += 32) {
+		__m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+		__m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+		for (size_t k = 0; k < d; ++k) {
+			const __m256 qk = _mm256_set1_ps(q[k]);
+			const float *kt = Kt + k * ldk + j;
+			acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(qk, _mm256_loadu_ps(kt)));
+			acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(qk, _mm256_loadu_ps(kt + 8)));
+			acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(qk, _mm256_loadu_ps(kt + 16)));
+			acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(qk, _mm256_loadu_ps(kt + 24)));
+		}
+		_mm256_storeu_ps(s + j, _mm256_mul_ps(acc0, scale_vec));
+		_mm256_storeu_ps(s + j + 8, _mm256_mul_ps(acc1, scale_vec));
+		_mm256_storeu_ps(s + j + 16, _mm256_mul_ps(acc2, scale_vec));
+		_mm256_storeu_ps(s + j + 24, _mm256_mul_ps(acc3, scale_vec));
+	}
+	for (; j < n8; j += 8) {
+		__m256 acc = _mm256_setzero_ps();
+		for (size_t k = 0; k < d; ++k) {
+			acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(q[k]), _mm256_loadu_ps(Kt + k * ldk + j)));
+		}
+		_mm256_storeu_ps(s + j, _mm256_mul_ps(acc, scale_vec));
+	}
+}
+
+// acc[0, dv) += sum_j p[j] * V_j over n keys, any dv. 32 columns at a
+// time kept in registers over all the keys, instead of a load and a store
+// of acc for every key.
+inline void accumulate_pv_avx(const float *p, const float *V, size_t n, size_t dv, float *acc) {
+	size_t c = 0;
+	for (; c + 32 <= dv; c += 32) {
+		__m256 a0 = _mm256_loadu_ps(acc + c), a1 = _mm256_loadu_ps(acc + c + 8);
+		__m256 a2 = _mm256_loadu_ps(acc + c + 16), a3 = _mm256_loadu_ps(acc + c + 24);
+		for (size_t j = 0; j < n; ++j) {
+			const __m256 pj = _mm256_set1_ps(p[j]);
+			const float *v = V + j * dv + c;
+			a0 = _mm256_add_ps(a0, _mm256_mul_ps(pj, _mm256_loadu_ps(v)));
+			a1 = _mm256_add_ps(a1, _mm256_mul_ps(pj, _mm256_loadu_ps(v + 8)));
+			a2 = _mm256_add_ps(a2, _mm256_mul_ps(pj, _mm256_loadu_ps(v + 16)));
+			a3 = _mm256_add_ps(a3, _mm256_mul_ps(pj, _mm256_loadu_ps(v + 24)));
+		}
+		_mm256_storeu_ps(acc + c, a0);
+		_mm256_storeu_ps(acc + c + 8, a1);
+		_mm256_storeu_ps(acc + c + 16, a2);
+		_mm256_storeu_ps(acc + c + 24, a3);
+	}
+	for (; c < dv; c += 8) {
+		__m256i mask = tail_mask_avx(std::min<size_t>(8, dv - c));
+		__m256 a = _mm256_maskload_ps(acc + c, mask);
+		for (size_t j = 0; j < n; ++j) {
+			a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_set1_ps(p[j]), _mm256_maskload_ps(V + j * dv + c, mask)));
+		}
+		_mm256_maskstore_ps(acc + c, mask, a);
+	}
+}
+
+inline void attention_naive_avx(const float *Q, const float *K, const float *V, float *O,
+								size_t N, size_t M, size_t d, size_t dv, int num_threads = 1) {
+	const float scale = 1.0f / std::sqrt((float)d);
+	const size_t ldk = SDIV(M, 8) * 8;
+	aligned_vector<float> Kt = transpose_keys(K, M, d, ldk);
+	aligned_vector<float> S(N * ldk);
+
+	// S = Q K^T / sqrt(d)
+	parallel_blocks(N, 1, num_threads, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			scores_avx(Q + i * d, Kt.data(), ldk, ldk, d, scale, S.data() + i * ldk);
+		}
+	});
+	// P = softmax(S), row by row and in place
+	parallel_blocks(N, 1, num_threads, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			softmax_avx(S.data() + i * ldk, S.data() + i * ldk, M);
+		}
+	});
+	// O = P V
+	parallel_blocks(N, 1, num_threads, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			std::fill(O + i * dv, O + (i + 1) * dv, 0.0f);
+			accumulate_pv_avx(S.data() + i * ldk, V, M, dv, O + i * dv);
+		}
+	});
+}
+
+inline void attention_flash_avx(const float *Q, const float *K, const float *V, float *O,
+								size_t N, size_t M, size_t d, size_t dv, int num_threads = 1) {
+	const float scale = 1.0f / std::sqrt((float)d);
+	const size_t ldk = SDIV(M, 8) * 8;
+	const __m256 neg_inf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+	aligned_vector<float> Kt = transpose_keys(K, M, d, ldk);
+
+	parallel_blocks(N, ATTN_BR, num_threads, [&](size_t begin, size_t end) {
+		// Per query of the block: running max, running sum, scores of the
+		// current key block and unnormalized output
+		alignas(32) float m[ATTN_BR], l[ATTN_BR];
+		alignas(32) float s[ATTN_BR][ATTN_BC];
+		aligned_vector<float> acc(ATTN_BR * dv);
+
+		for (size_t q0 = begin; q0 < end; q0 += ATTN_BR) {
+			const size_t rows = std::min<size_t>(ATTN_BR, end - q0);
+			std::fill(m, m + rows, -std::numeric_limits<float>::infinity());
+			std::fill(l, l + rows, 0.0f);
+			std::fill(acc.begin(), acc.end(), 0.0f);
+
+			for (size_t k0 = 0; k0 < M; k0 += ATTN_BC) {
+				const size_t n = std::min<size_t>(ATTN_BC, M - k0);
+				const size_t n8 = SDIV(n, 8) * 8;
+				for (size_t r = 0; r < rows; ++r) {
+					float *sr = s[r];
+					scores_avx(Q + (q0 + r) * d, Kt.data() + k0, ldk, n8, d, scale, sr);
+					// The padding keys of the last block (score 0) must not
+					// raise the maximum
+					if (n != n8) {
+						__m256i mask = tail_mask_avx(n % 8);
+						__m256 last = _mm256_loadu_ps(sr + n8 - 8);
+						_mm256_storeu_ps(sr + n8 - 8, _mm256_blendv_ps(neg_inf, last, _mm256_castsi256_ps(mask)));
+					}
+
+					// New maximum and rescaling of the previous blocks
+					__m256 max_vec = neg_inf;
+					for (size_t j = 0; j < n8; j += 8) {
+						max_vec = _mm256_max_ps(max_vec, _mm256_loadu_ps(sr + j));
+					}
+					const float m_new = std::max(m[r], hmax_avx(max_vec));
+					const float alpha = std::exp(m[r] - m_new);
+					m[r] = m_new;
+
+					// p = exp(s - m_new), in place. exp256_ps(-inf) is about
+					// 1e-38 instead of 0, so the padding lanes are zeroed
+					__m256 m_vec = _mm256_set1_ps(m_new);
+					__m256 sum_vec = _mm256_setzero_ps();
+					for (size_t j = 0; j < n8; j += 8) {
+						__m256 p = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(sr + j), m_vec));
+						if (j + 8 > n) {
+							p = _mm256_and_ps(p, _mm256_castsi256_ps(tail_mask_avx(n % 8)));
+						}
+						_mm256_storeu_ps(sr + j, p);
+						sum_vec = _mm256_add_ps(sum_vec, p);
+					}
+					l[r] = l[r] * alpha + hsum_avx(sum_vec);
+
+					float *acc_r = acc.data() + r * dv;
+					if (alpha != 1.0f) {
+						for (size_t c = 0; c < dv; ++c) {
+							acc_r[c] *= alpha;
+						}
+					}
+					accumulate_pv_avx(sr, V + k0 * dv, n, dv, acc_r);
+				}
+			}
+
+			for (size_t r = 0; r < rows; ++r) {
+				const float inv_l = 1.0f / l[r];
+				for (size_t c = 0; c < dv; ++c) {
+					O[(q0 + r) * dv + c] = acc[r * dv + c] * inv_l;
+				}
+			}
+		}
+	});
+}
+
+#endif // ATTENTION_AVX_HPP
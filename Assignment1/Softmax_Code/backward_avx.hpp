@@ -0,0 +1,130 @@
+#ifndef BACKWARD_AVX_HPP
+#define BACKWARD_AVX_HPP
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <hpc_helpers.hpp>
+#include <par_avx.hpp>
+
+// Backward pass of the softmax: given the output y = softmax(x) and the
+// gradient dy of the loss with respect to y, the gradient with respect to x is
+//     dx[i] = y[i] * (dy[i] - dot(dy, y))
+// The first pass computes the dot product, the second one writes dx; no
+// temporary vector is needed, and dx may be the same buffer as dy.
+// Any K is supported, the tails are handled with masks.
+
+// Partial dot product of a thread, padded to a cache line to avoid false sharing
+struct alignas(64) PartialDot {
+	float dot;
+};
+
+// dot(y, dy) over [begin, end), with two accumulators to hide the latency
+// of the additions
+inline float dot_range_avx(const float *y, const float *dy, size_t begin, size_t end) {
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	size_t n = end - begin;
+	size_t body16 = begin + n - (n % 16);
+	size_t body = begin + n - (n % 8);
+	for (size_t i = begin; i < body16; i += 16) {
+		acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(dy + i)));
+		acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(y + i + 8), _mm256_loadu_ps(dy + i + 8)));
+	}
+	if (body16 < body) {
+		acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(y + body16), _mm256_loadu_ps(dy + body16)));
+	}
+	// Masked-out lanes are loaded as 0 and do not contribute
+	if (n % 8 != 0) {
+		__m256i mask = tail_mask_avx(n % 8);
+		acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_maskload_ps(y + body, mask), _mm256_maskload_ps(dy + body, mask)));
+	}
+	return hsum_avx(_mm256_add_ps(acc0, acc1));
+}
+
+// dx[i] = y[i] * (dy[i] - dot) over [begin, end)
+inline void backward_range_avx(const float *y, const float *dy, float *dx, size_t begin, size_t end, float dot) {
+	__m256 dot_vec = _mm256_set1_ps(dot);
+	size_t n = end - begin;
+	size_t body = begin + n - (n % 8);
+	for (size_t i = begin; i < body; i += 8) {
+		__m256 diff = _mm256_sub_ps(_mm256_loadu_ps(dy + i), dot_vec);
+		_mm256_storeu_ps(dx + i, _mm256_mul_ps(_mm256_loadu_ps(y + i), diff));
+	}
+	if (n % 8 != 0) {
+		__m256i mask = tail_mask_avx(n % 8);
+		__m256 diff = _mm256_sub_ps(_mm256_maskload_ps(dy + body, mask), dot_vec);
+		_mm256_maskstore_ps(dx + body, mask, _mm256_mul_ps(_mm256_maskload_ps(y + body, mask), diff));
+	}
+}
+
+// Sequential backward pass of a vector of K elements
+inline void softmax_backward_avx(const float *y, const float *dy, float *dx, size_t K) {
+	backward_range_avx(y, dy, dx, 0, K, dot_range_avx(y, dy, 0, K));
+}
+
+// Multi-threaded backward pass, with the same partitioning as
+// softmax_par_avx: each thread computes the partial dot product of its
+// block, and after a barrier every thread sums the partials and updates
+// its block.
+inline void softmax_backward_par_avx(const float *y, const float *dy, float *dx, size_t K, int num_threads) {
+	if (num_threads <= 1) {
+		softmax_backward_avx(y, dy, dx, K);
+		return;
+	}
+	std::vector<PartialDot> partials(num_threads);
+	Barrier barrier(num_threads);
+	size_t block = SDIV(SDIV(K, 8), (size_t)num_threads) * 8;
+
+	auto worker = [&](int id) {
+		size_t begin = std::min(K, id * block);
+		size_t end = std::min(K, begin + block);
+
+		// First pass: partial dot product, then combine
+		partials[id].dot = dot_range_avx(y, dy, begin, end);
+		barrier.wait();
+		float dot = 0.0f;
+		for (int t = 0; t < num_threads; ++t) {
+			dot += partials[t].dot;
+		}
+
+		// Second pass: gradient
+		backward_range_avx(y, dy, dx, begin, end, dot);
+	};
+
+	// The calling thread works as thread 0
+	std::vector<std::thread> threads;
+	for (int t = 1; t < num_threads; ++t) {
+		threads.emplace_back(worker, t);
+	}
+	worker(0);
+	for (auto &t : threads) {
+		t.join();
+	}
+}
+
+// Row-wise backward pass of a [rows x K] matrix stored with leading dimension
+// ld (as in softmax_batched_avx), the same for y, dy and dx. The rows are
+// split in contiguous blocks among the threads, each row is processed by a
+// single thread, so no synchronization is needed.
+inline void softmax_backward_batched_avx(const float *y, const float *dy, float *dx, size_t rows, size_t K,
+										 size_t ld, int num_threads) {
+	auto worker = [&](size_t first, size_t last) {
+		for (size_t r = first; r < last; ++r) {
+			softmax_backward_avx(y + r * ld, dy + r * ld, dx + r * ld, K);
+		}
+	};
+	num_threads = (int)std::min<size_t>(std::max(num_threads, 1), std::max<size_t>(rows, 1));
+	size_t block = SDIV(rows, (size_t)num_threads);
+
+	std::vector<std::thread> threads;
+	for (int t = 1; t < num_threads; ++t) {
+		threads.emplace_back(worker, std::min(rows, t * block), std::min(rows, (t + 1) * block));
+	}
+	worker(0, std::min(rows, block));
+	for (auto &t : threads) {
+		t.join();
+	}
+}
+
+#endif // BACKWARD_AVX_HPP
@@ -0,0 +1,276 @@
+#ifndef CHUNKED_AVX_HPP
+#define CHUNKED_AVX_HPP
+
+#include <cmath>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <aligned_allocator.hpp>
+#include <logsoftmax_avx.hpp>
+
+// Softmax of a vector of floats stored in a file (raw float32), with memory
+// bounded by four chunks whatever the size of the file.
+// The first pass reads the file once and keeps the online maximum and sum of
+// the exponentials, combining the statistics of every chunk; the second pass
+// reads it again and writes exp(x - max) / sum to the output file.
+// Reads and writes are double buffered: a reader thread fills one chunk
+// while the other is being processed, and a writer thread writes one chunk
+// while the other is being filled.
+
+// Maximum and sum of exp(x - max) of a part of the vector
+struct SoftmaxStats {
+	float max = -std::numeric_limits<float>::infinity();
+	float sum = 0.0f;
+};
+
+// Statistics of the union of two parts: both sums are rescaled to the
+// larger maximum
+inline SoftmaxStats combine_stats(const SoftmaxStats &a, const SoftmaxStats &b) {
+	if (b.sum == 0.0f) return a;
+	if (a.sum == 0.0f) return b;
+	SoftmaxStats r;
+	r.max = std::max(a.max, b.max);
+	r.sum = a.sum * std::exp(a.max - r.max) + b.sum * std::exp(b.max - r.max);
+	return r;
+}
+
+inline SoftmaxStats chunk_stats_avx(const float *input, size_t n) {
+	SoftmaxStats s;
+	s.max = max_avx(input, n);
+	s.sum = expsum_avx(input, n, s.max);
+	return s;
+}
+
+// output[i] = exp(input[i] - max) * inv_sum, any n
+inline void exp_normalize_avx(const float *input, float *output, size_t n, float max, float inv_sum) {
+	size_t n8 = n - (n % 8);
+	__m256 max_vec = _mm256_set1_ps(max);
+	__m256 factor = _mm256_set1_ps(inv_sum);
+	for (size_t i = 0; i < n8; i += 8) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(input + i), max_vec));
+		_mm256_storeu_ps(output + i, _mm256_mul_ps(exp_val, factor));
+	}
+	if (n % 8 != 0) {
+		__m256i mask = tail_mask_avx(n % 8);
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_maskload_ps(input + n8, mask), max_vec));
+		_mm256_maskstore_ps(output + n8, mask, _mm256_mul_ps(exp_val, factor));
+	}
+}
+
+// Reads a file sequentially in chunks of floats, with a thread reading the
+// next chunk while the caller processes the current one
+class ChunkReader {
+public:
+	ChunkReader(const std::string &path, size_t chunk) : chunk(chunk) {
+		fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw std::runtime_error("cannot open " + path);
+		}
+		posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		for (auto &b : buffers) {
+			b.resize(chunk);
+		}
+		reader = std::thread(&ChunkReader::run, this);
+	}
+
+	~ChunkReader() {
+		{
+			std::lock_guard<std::mutex> lock(m);
+			stop = true;
+		}
+		cv.notify_all();
+		reader.join();
+		close(fd);
+	}
+
+	// Next chunk and its number of floats in n, nullptr at the end of the
+	// file. The chunk returned by the previous call is given back to the reader.
+	const float *next(size_t &n) {
+		std::unique_lock<std::mutex> lock(m);
+		if (started) {
+			full[current] = false;
+			current ^= 1;
+			cv.notify_all();
+		}
+		started = true;
+		cv.wait(lock, [&] { return full[current]; });
+		n = sizes[current];
+		return n ? buffers[current].data() : nullptr;
+	}
+
+	bool failed() const { return error; }
+
+private:
+	void run() {
+		for (int b = 0;; b ^= 1) {
+			{
+				std::unique_lock<std::mutex> lock(m);
+				cv.wait(lock, [&] { return !full[b] || stop; });
+				if (stop) return;
+			}
+			// Fill the chunk, the last one can be shorter
+			char *p = reinterpret_cast<char *>(buffers[b].data());
+			size_t bytes = 0;
+			while (bytes < chunk * sizeof(float)) {
+				ssize_t r = read(fd, p + bytes, chunk * sizeof(float) - bytes);
+				if (r <= 0) {
+					error = error || r < 0;
+					break;
+				}
+				bytes += r;
+			}
+			std::lock_guard<std::mutex> lock(m);
+			sizes[b] = bytes / sizeof(float);
+			full[b] = true;
+			cv.notify_all();
+			if (sizes[b] == 0) return;
+		}
+	}
+
+	int fd;
+	size_t chunk;
+	aligned_vector<float> buffers[2];
+	size_t sizes[2] = {0, 0};
+	bool full[2] = {false, false};
+	int current = 0;
+	bool started = false;
+	bool stop = false;
+	bool error = false;
+	std::mutex m;
+	std::condition_variable cv;
+	std::thread reader;
+};
+
+// Writes a file sequentially in chunks of floats, with a thread writing one
+// chunk while the caller fills the other one
+class ChunkWriter {
+public:
+	ChunkWriter(const std::string &path, size_t chunk) {
+		fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			throw std::runtime_error("cannot create " + path);
+		}
+		for (auto &b : buffers) {
+			b.resize(chunk);
+		}
+		writer = std::thread(&ChunkWriter::run, this);
+	}
+
+	~ChunkWriter() {
+		finish();
+		close(fd);
+	}
+
+	// Free chunk to be filled, waits until it has been written
+	float *buffer() {
+		std::unique_lock<std::mutex> lock(m);
+		cv.wait(lock, [&] { return sizes[current] == 0; });
+		return buffers[current].data();
+	}
+
+	// Hands the first n floats of the chunk returned by buffer() to the writer
+	void submit(size_t n) {
+		std::lock_guard<std::mutex> lock(m);
+		sizes[current] = n;
+		current ^= 1;
+		cv.notify_all();
+	}
+
+	// Waits until everything has been written, returns false on errors
+	bool finish() {
+		if (writer.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(m);
+				stop = true;
+			}
+			cv.notify_all();
+			writer.join();
+		}
+		return !error;
+	}
+
+private:
+	void run() {
+		for (int b = 0;; b ^= 1) {
+			size_t n;
+			{
+				std::unique_lock<std::mutex> lock(m);
+				cv.wait(lock, [&] { return sizes[b] != 0 || stop; });
+				if (sizes[b] == 0) return;
+				n = sizes[b];
+			}
+			const char *p = reinterpret_cast<const char *>(buffers[b].data());
+			size_t bytes = 0;
+			while (!error && bytes < n * sizeof(float)) {
+				ssize_t w = write(fd, p + bytes, n * sizeof(float) - bytes);
+				if (w < 0) {
+					error = true;
+				} else {
+					bytes += w;
+				}
+			}
+			std::lock_guard<std::mutex> lock(m);
+			sizes[b] = 0;
+			cv.notify_all();
+		}
+	}
+
+	int fd;
+	aligned_vector<float> buffers[2];
+	size_t sizes[2] = {0, 0};
+	int current = 0;
+	bool stop = false;
+	bool error = false;
+	std::mutex m;
+	std::condition_variable cv;
+	std::thread writer;
+};
+
+// Streaming softmax from input_path to output_path, chunk floats at a time.
+// Returns the statistics of the whole vector (sum = 0 if it is empty).
+// Throws if the input cannot be read or its size is not a whole number of
+// floats.
+inline SoftmaxStats softmax_file_avx(const std::string &input_path, const std::string &output_path, size_t chunk) {
+	struct stat st;
+	if (stat(input_path.c_str(), &st) != 0) {
+		throw std::runtime_error("cannot open " + input_path);
+	}
+	if (st.st_size % sizeof(float) != 0) {
+		throw std::runtime_error(input_path + ": size is not a multiple of " + std::to_string(sizeof(float)) + " bytes");
+	}
+
+	// First pass: online maximum and sum
+	SoftmaxStats stats;
+	{
+		ChunkReader reader(input_path, chunk);
+		size_t n;
+		while (const float *in = reader.next(n)) {
+			stats = combine_stats(stats, chunk_stats_avx(in, n));
+		}
+		if (reader.failed()) {
+			throw std::runtime_error("error reading " + input_path);
+		}
+	}
+
+	// Second pass: normalized exponentials
+	ChunkReader reader(input_path, chunk);
+	ChunkWriter writer(output_path, chunk);
+	float inv_sum = 1.0f / stats.sum;
+	size_t n;
+	while (const float *in = reader.next(n)) {
+		float *out = writer.buffer();
+		exp_normalize_avx(in, out, n, stats.max, inv_sum);
+		writer.submit(n);
+	}
+	if (reader.failed() || !writer.finish()) {
+		throw std::runtime_error("error reading " + input_path + " or writing " + output_path);
+	}
+	return stats;
+}
+
+#endif // CHUNKED_AVX_HPP
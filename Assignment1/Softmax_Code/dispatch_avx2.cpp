@@ -0,0 +1,7 @@
+// Compiled with -mavx2 -mfma, see the Makefile
+#include <softmax_dispatch.hpp>
+#include <softmax_avx.hpp>
+
+void softmax_dispatch_avx2(const float *input, float *output, size_t K) {
+	softmax_avx(input, output, K);
+}
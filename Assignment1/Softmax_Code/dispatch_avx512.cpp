@@ -0,0 +1,7 @@
+// Compiled with -mavx512f, see the Makefile
+#include <softmax_dispatch.hpp>
+#include <softmax_avx512.hpp>
+
+void softmax_dispatch_avx512(const float *input, float *output, size_t K) {
+	softmax_avx512(input, output, K);
+}
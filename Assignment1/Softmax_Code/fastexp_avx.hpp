@@ -0,0 +1,120 @@
+#ifndef FASTEXP_AVX_HPP
+#define FASTEXP_AVX_HPP
+
+#include <softmax_avx.hpp>
+
+// Exponential specialized for the softmax, where after the subtraction of the
+// maximum the argument is always <= 0: there is no overflow to handle, and
+// the only clamp is the one that keeps 2^n a normal float.
+// exp(x) = 2^n * exp(r), with n = round(x / log(2)) and |r| <= log(2)/2, and
+// exp(r) is approximated with a polynomial whose degree is chosen at compile
+// time. Coefficients are minimax for the relative error on [-log(2)/2, log(2)/2].
+
+enum class ExpAccuracy { fast, medium, accurate };
+
+template <ExpAccuracy A> struct ExpPoly;
+
+// degree 3, max relative error 7.5e-5
+template <> struct ExpPoly<ExpAccuracy::fast> {
+	static constexpr int degree = 3;
+	static constexpr float c[] = {
+		9.999280735e-01f, 1.000164186e+00f, 5.049632642e-01f, 1.656684235e-01f
+	};
+};
+
+// degree 4, max relative error 2.6e-6
+template <> struct ExpPoly<ExpAccuracy::medium> {
+	static constexpr int degree = 4;
+	static constexpr float c[] = {
+		9.999992614e-01f, 9.999634049e-01f, 5.000435866e-01f, 1.679090722e-01f,
+		4.145860819e-02f
+	};
+};
+
+// degree 6, max relative error 1.9e-9 (below float rounding)
+template <> struct ExpPoly<ExpAccuracy::accurate> {
+	static constexpr int degree = 6;
+	static constexpr float c[] = {
+		1.000000001e+00f, 1.000000036e+00f, 4.999999208e-01f, 1.666642017e-01f,
+		4.166822557e-02f, 8.374815804e-03f, 1.383684599e-03f
+	};
+};
+
+// a * b + c, with a single rounding where FMA is available
+inline __m256 fmadd_avx(__m256 a, __m256 b, __m256 c) {
+#ifdef __FMA__
+	return _mm256_fmadd_ps(a, b, c);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+// exp(x) for x <= 0. Inputs below -87 return exp(-87) ~ 1.6e-38, which is
+// negligible once divided by a softmax sum (always >= 1).
+template <ExpAccuracy A>
+inline __m256 exp256_neg_ps(__m256 x) {
+	using P = ExpPoly<A>;
+	x = _mm256_max_ps(x, _mm256_set1_ps(-87.0f));
+
+	__m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+							   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+	// r = x - n*log(2), with log(2) split in two parts (Cody-Waite)
+	__m256 r = fmadd_avx(n, _mm256_set1_ps(-0.693359375f), x);
+	r = fmadd_avx(n, _mm256_set1_ps(2.12194440e-4f), r);
+
+	// Horner scheme, the loop is unrolled by the compiler
+	__m256 p = _mm256_set1_ps(P::c[P::degree]);
+	for (int j = P::degree - 1; j >= 0; --j) {
+		p = fmadd_avx(p, r, _mm256_set1_ps(P::c[j]));
+	}
+
+	// build 2^n (n >= -126 thanks to the clamp)
+	v8si e = avx2_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+	e = avx2_mm256_slli_epi32(e, 23);
+	return _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+}
+
+// Accuracy used by softmax_fastexp_avx when not given explicitly, it can be
+// changed at compile time with -DFASTEXP_ACCURACY=fast|medium|accurate
+#ifndef FASTEXP_ACCURACY
+#define FASTEXP_ACCURACY medium
+#endif
+
+// Same three passes as softmax_avx, using exp256_neg_ps. The tail is handled
+// with masks, so there is no restriction on K.
+template <ExpAccuracy A = ExpAccuracy::FASTEXP_ACCURACY>
+inline void softmax_fastexp_avx(const float *input, float *output, size_t K) {
+	const __m256 lowest = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	size_t K8 = K - (K % 8);
+	__m256i mask = tail_mask_avx(K % 8);
+	__m256 mask_ps = _mm256_castsi256_ps(mask);
+
+	// Find the maximum to stabilize the computation of the exponential
+	__m256 tail_val = _mm256_blendv_ps(lowest, _mm256_maskload_ps(input + K8, mask), mask_ps);
+	__m256 max_val = tail_val;
+	for (size_t i = 0; i < K8; i += 8) {
+		max_val = _mm256_max_ps(max_val, _mm256_loadu_ps(input + i));
+	}
+	__m256 max_input_vec = _mm256_set1_ps(hmax_avx(max_val));
+
+	// Computes all exponentials with the shift of max_val and the total sum
+	__m256 sum_vec = _mm256_setzero_ps();
+	for (size_t i = 0; i < K8; i += 8) {
+		__m256 exp_val = exp256_neg_ps<A>(_mm256_sub_ps(_mm256_loadu_ps(input + i), max_input_vec));
+		_mm256_storeu_ps(output + i, exp_val);
+		sum_vec = _mm256_add_ps(sum_vec, exp_val);
+	}
+	__m256 exp_tail = _mm256_and_ps(exp256_neg_ps<A>(_mm256_sub_ps(tail_val, max_input_vec)), mask_ps);
+	_mm256_maskstore_ps(output + K8, mask, exp_tail);
+	sum_vec = _mm256_add_ps(sum_vec, exp_tail);
+
+	// Normalize by the total sum
+	__m256 sum_vect = norm_factor_avx<default_normalize>(hsum_avx(sum_vec));
+	for (size_t i = 0; i < K8; i += 8) {
+		_mm256_storeu_ps(output + i, normalize_avx<default_normalize>(_mm256_loadu_ps(output + i), sum_vect));
+	}
+	_mm256_maskstore_ps(output + K8, mask, normalize_avx<default_normalize>(exp_tail, sum_vect));
+}
+
+#endif // FASTEXP_AVX_HPP
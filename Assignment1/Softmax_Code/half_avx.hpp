@@ -0,0 +1,137 @@
+#ifndef HALF_AVX_HPP
+#define HALF_AVX_HPP
+
+#include <cstring>
+#include <softmax_avx.hpp>
+
+// Softmax on 16-bit inputs: the values are widened to fp32 in registers right
+// after the load (F16C for fp16, a 16-bit shift for bf16), so memory only
+// sees 2 bytes per element. The output can be fp32 or the same 16-bit format.
+// fp16 needs F16C (-march=native on any AVX2 machine).
+
+enum class HalfFormat { fp16, bf16 };
+
+// Widen 8 consecutive 16-bit values to fp32
+template <HalfFormat F>
+inline __m256 load_half_avx(const uint16_t *p) {
+	__m128i h = _mm_loadu_si128((const __m128i*)p);
+	if constexpr (F == HalfFormat::fp16) {
+		return _mm256_cvtph_ps(h);
+	} else {
+		// bf16 is the upper half of an fp32
+		return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16));
+	}
+}
+
+// Narrow 8 fp32 values, rounding to nearest even
+template <HalfFormat F>
+inline void store_half_avx(uint16_t *p, __m256 v) {
+	__m128i h;
+	if constexpr (F == HalfFormat::fp16) {
+		h = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	} else {
+		// add 0x7fff plus the lowest kept bit, then keep the upper 16 bits
+		// (no NaN handling: softmax values are in [0, 1])
+		__m256i x = _mm256_castps_si256(v);
+		__m256i lsb = _mm256_and_si256(_mm256_srli_epi32(x, 16), _mm256_set1_epi32(1));
+		x = _mm256_add_epi32(x, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7fff)));
+		x = _mm256_srli_epi32(x, 16);
+		// packus works per 128-bit lane: put the two packed halves together
+		x = _mm256_permute4x64_epi64(_mm256_packus_epi32(x, x), 0xD8);
+		h = _mm256_castsi256_si128(x);
+	}
+	_mm_storeu_si128((__m128i*)p, h);
+}
+
+// There are no masked 16-bit loads/stores in AVX2: the last n < 8 elements
+// go through a small buffer, the unused lanes are masked by the caller
+template <HalfFormat F>
+inline __m256 load_half_tail_avx(const uint16_t *p, size_t n) {
+	uint16_t buf[8] = {0};
+	std::memcpy(buf, p, n * sizeof(uint16_t));
+	return load_half_avx<F>(buf);
+}
+
+template <HalfFormat F>
+inline void store_half_tail_avx(uint16_t *p, __m256 v, size_t n) {
+	uint16_t buf[8];
+	store_half_avx<F>(buf, v);
+	std::memcpy(p, buf, n * sizeof(uint16_t));
+}
+
+// Maximum and sum of exp(x - max) of a 16-bit vector, any K >= 1
+template <HalfFormat F>
+inline float max_half_avx(const uint16_t *input, size_t K) {
+	size_t K8 = K - (K % 8);
+	__m256 max_val = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	for (size_t i = 0; i < K8; i += 8) {
+		max_val = _mm256_max_ps(max_val, load_half_avx<F>(input + i));
+	}
+	if (K % 8 != 0) {
+		__m256 mask = _mm256_castsi256_ps(tail_mask_avx(K % 8));
+		max_val = _mm256_blendv_ps(max_val, _mm256_max_ps(max_val, load_half_tail_avx<F>(input + K8, K % 8)), mask);
+	}
+	return hmax_avx(max_val);
+}
+
+// Softmax of a 16-bit input with fp32 output: the exponentials are stored in
+// the output and normalized in place, as in softmax_avx
+template <HalfFormat F, Normalize N = default_normalize>
+inline void softmax_half_avx(const uint16_t *input, float *output, size_t K) {
+	size_t K8 = K - (K % 8);
+	__m256i mask = tail_mask_avx(K % 8);
+	__m256 max_vec = _mm256_set1_ps(max_half_avx<F>(input, K));
+
+	__m256 sum_vec = _mm256_setzero_ps();
+	for (size_t i = 0; i < K8; i += 8) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(load_half_avx<F>(input + i), max_vec));
+		_mm256_storeu_ps(output + i, exp_val);
+		sum_vec = _mm256_add_ps(sum_vec, exp_val);
+	}
+	if (K % 8 != 0) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(load_half_tail_avx<F>(input + K8, K % 8), max_vec));
+		_mm256_maskstore_ps(output + K8, mask, exp_val);
+		sum_vec = _mm256_add_ps(sum_vec, _mm256_and_ps(exp_val, _mm256_castsi256_ps(mask)));
+	}
+
+	__m256 factor = norm_factor_avx<N>(hsum_avx(sum_vec));
+	for (size_t i = 0; i < K8; i += 8) {
+		_mm256_storeu_ps(output + i, normalize_avx<N>(_mm256_loadu_ps(output + i), factor));
+	}
+	if (K % 8 != 0) {
+		__m256 output_val = _mm256_maskload_ps(output + K8, mask);
+		_mm256_maskstore_ps(output + K8, mask, normalize_avx<N>(output_val, factor));
+	}
+}
+
+// Softmax of a 16-bit input with output in the same format. Storing the
+// exponentials in 16 bits would round them before the normalization, so the
+// second pass only sums them and the third one recomputes them from the input
+// (2 more bytes read per element instead of 4 written and 4 read in fp32).
+template <HalfFormat F, Normalize N = default_normalize>
+inline void softmax_half_avx(const uint16_t *input, uint16_t *output, size_t K) {
+	size_t K8 = K - (K % 8);
+	__m256 mask = _mm256_castsi256_ps(tail_mask_avx(K % 8));
+	__m256 max_vec = _mm256_set1_ps(max_half_avx<F>(input, K));
+
+	__m256 sum_vec = _mm256_setzero_ps();
+	for (size_t i = 0; i < K8; i += 8) {
+		sum_vec = _mm256_add_ps(sum_vec, exp256_ps(_mm256_sub_ps(load_half_avx<F>(input + i), max_vec)));
+	}
+	if (K % 8 != 0) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(load_half_tail_avx<F>(input + K8, K % 8), max_vec));
+		sum_vec = _mm256_add_ps(sum_vec, _mm256_and_ps(exp_val, mask));
+	}
+
+	__m256 factor = norm_factor_avx<N>(hsum_avx(sum_vec));
+	for (size_t i = 0; i < K8; i += 8) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(load_half_avx<F>(input + i), max_vec));
+		store_half_avx<F>(output + i, normalize_avx<N>(exp_val, factor));
+	}
+	if (K % 8 != 0) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(load_half_tail_avx<F>(input + K8, K % 8), max_vec));
+		store_half_tail_avx<F>(output + K8, normalize_avx<N>(exp_val, factor), K % 8);
+	}
+}
+
+#endif // HALF_AVX_HPP
@@ -0,0 +1,66 @@
+// Compiled with the auto-vectorization flags, see the Makefile
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <softmax_kernels.hpp>
+
+// Writes exp(input[i] - max_val) in output and returns their sum,
+// accumulated as selected by A (no kahan, see softmax_accumulate.hpp)
+template <Accumulate A>
+static float expsum_auto(const float *__restrict input, float *__restrict output, size_t K, float max_val) {
+	static_assert(A != Accumulate::kahan, "-ffast-math removes the Kahan compensation");
+	if constexpr (A == Accumulate::flt) {
+		float sum = 0.0f;
+		for (size_t i = 0; i < K; ++i) {
+			output[i] = std::exp(input[i] - max_val);
+			sum += output[i];
+		}
+		return sum;
+	} else if constexpr (A == Accumulate::blocked) {
+		float sum = 0.0f;
+		for (size_t b = 0; b < K; b += ACCUMULATE_BLOCK) {
+			const size_t end = std::min(K, b + ACCUMULATE_BLOCK);
+			float block = 0.0f;
+			for (size_t i = b; i < end; ++i) {
+				output[i] = std::exp(input[i] - max_val);
+				block += output[i];
+			}
+			sum += block;
+		}
+		return sum;
+	} else {
+		double sum = 0.0;
+		for (size_t i = 0; i < K; ++i) {
+			output[i] = std::exp(input[i] - max_val);
+			sum += output[i];
+		}
+		return sum;
+	}
+}
+
+// Same scalar code, left to the auto-vectorizer (__restrict, -ffast-math)
+template <Accumulate A>
+void softmax_kernel_auto_acc(const float *__restrict input, float *__restrict output, size_t K) {
+	// Find the maximum to stabilize the computation of the exponential
+	float max_val = -std::numeric_limits<float>::infinity();
+	for (size_t i = 0; i < K; ++i) {
+		max_val = std::max(max_val, input[i]);
+	}
+
+	// computes all exponentials with the shift of max_val and the total sum
+	float sum = expsum_auto<A>(input, output, K, max_val);
+
+	// normalize by multiplying for the reciprocal of the total sum
+	const float inv_sum = 1.0f / sum;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] *= inv_sum;
+	}
+}
+
+template void softmax_kernel_auto_acc<Accumulate::flt>(const float *, float *, size_t);
+template void softmax_kernel_auto_acc<Accumulate::blocked>(const float *, float *, size_t);
+template void softmax_kernel_auto_acc<Accumulate::f64>(const float *, float *, size_t);
+
+void softmax_kernel_auto(const float *__restrict input, float *__restrict output, size_t K) {
+	softmax_kernel_auto_acc<default_accumulate == Accumulate::kahan ? Accumulate::f64 : default_accumulate>(input, output, K);
+}
@@ -0,0 +1,45 @@
+// Compiled with -march=native, see the Makefile
+#include <softmax_kernels.hpp>
+#include <softmax_avx.hpp>
+#include <online_avx.hpp>
+#include <stream_avx.hpp>
+#include <par_avx.hpp>
+#include <smallk_avx.hpp>
+
+template <Accumulate A>
+void softmax_kernel_avx_acc(const float *input, float *output, size_t K) {
+	softmax_avx<default_normalize, A>(input, output, K);
+}
+
+template void softmax_kernel_avx_acc<Accumulate::flt>(const float *, float *, size_t);
+template void softmax_kernel_avx_acc<Accumulate::kahan>(const float *, float *, size_t);
+template void softmax_kernel_avx_acc<Accumulate::blocked>(const float *, float *, size_t);
+template void softmax_kernel_avx_acc<Accumulate::f64>(const float *, float *, size_t);
+
+void softmax_kernel_avx(const float *input, float *output, size_t K) {
+	softmax_avx(input, output, K);
+}
+
+void softmax_kernel_online(const float *input, float *output, size_t K) {
+	softmax_online_avx(input, output, K);
+}
+
+// Non-temporal stores only when the data do not fit in the last level cache
+void softmax_kernel_stream(const float *input, float *output, size_t K) {
+	softmax_select_avx(input, output, K);
+}
+
+// Non-temporal stores for any K, so that the checks reach the streaming path
+// (head, aligned body and tail) without buffers larger than the LLC
+void softmax_kernel_stream_nt(const float *input, float *output, size_t K) {
+	softmax_stream_avx(input, output, K);
+}
+
+// Kernels specialized at compile time for K <= SMALL_K_MAX
+void softmax_kernel_smallk(const float *input, float *output, size_t K) {
+	softmax_smallk_avx(input, output, K);
+}
+
+void softmax_kernel_par(const float *input, float *output, size_t K, int num_threads) {
+	softmax_par_avx(input, output, K, num_threads);
+}
@@ -0,0 +1,65 @@
+#include <softmax_kernels.hpp>
+#include <softmax_dispatch.hpp>
+
+// Adapts a sequential kernel to the common signature
+template <void (*F)(const float *, float *, size_t)>
+static void sequential(const float *input, float *output, size_t K, int) {
+	F(input, output, K);
+}
+
+// Three passes: input read twice, exponentials written and read back,
+// output written (6K floats)
+static double three_pass(size_t) {
+	return 6.0;
+}
+
+// Online: input read twice, output written once (4K floats)
+static double two_pass(size_t) {
+	return 4.0;
+}
+
+// smallk keeps the row in registers up to SMALL_K_MAX (input read once,
+// output written once), above it falls back to the three-pass softmax_avx
+static double small_k(size_t K) {
+	return K <= 128 ? 3.0 : 6.0;
+}
+
+static bool has_avx512() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx512f");
+}
+
+const std::vector<SoftmaxKernel> &softmax_kernels() {
+	static const std::vector<SoftmaxKernel> kernels = {
+		{"plain", sequential<softmax_kernel_plain>, true, false, three_pass},
+		{"auto", sequential<softmax_kernel_auto>, true, false, three_pass},
+		{"avx", sequential<softmax_kernel_avx>, true, false, three_pass},
+		{"online", sequential<softmax_kernel_online>, true, false, two_pass},
+		{"stream", sequential<softmax_kernel_stream>, true, false, three_pass},
+		{"stream_nt", sequential<softmax_kernel_stream_nt>, true, false, three_pass},
+		{"smallk", sequential<softmax_kernel_smallk>, true, false, small_k},
+		{"par", softmax_kernel_par, true, true, three_pass},
+		{"avx512", sequential<softmax_dispatch_avx512>, has_avx512(), false, three_pass},
+		{"plain_flt", sequential<softmax_kernel_plain_acc<Accumulate::flt>>, true, false, three_pass},
+		{"plain_kahan", sequential<softmax_kernel_plain_acc<Accumulate::kahan>>, true, false, three_pass},
+		{"plain_blocked", sequential<softmax_kernel_plain_acc<Accumulate::blocked>>, true, false, three_pass},
+		{"plain_f64", sequential<softmax_kernel_plain_acc<Accumulate::f64>>, true, false, three_pass},
+		{"auto_flt", sequential<softmax_kernel_auto_acc<Accumulate::flt>>, true, false, three_pass},
+		{"auto_blocked", sequential<softmax_kernel_auto_acc<Accumulate::blocked>>, true, false, three_pass},
+		{"auto_f64", sequential<softmax_kernel_auto_acc<Accumulate::f64>>, true, false, three_pass},
+		{"avx_flt", sequential<softmax_kernel_avx_acc<Accumulate::flt>>, true, false, three_pass},
+		{"avx_kahan", sequential<softmax_kernel_avx_acc<Accumulate::kahan>>, true, false, three_pass},
+		{"avx_blocked", sequential<softmax_kernel_avx_acc<Accumulate::blocked>>, true, false, three_pass},
+		{"avx_f64", sequential<softmax_kernel_avx_acc<Accumulate::f64>>, true, false, three_pass}
+	};
+	return kernels;
+}
+
+const SoftmaxKernel *find_softmax_kernel(const std::string &name) {
+	for (const auto &kernel : softmax_kernels()) {
+		if (name == kernel.name) {
+			return &kernel;
+		}
+	}
+	return nullptr;
+}
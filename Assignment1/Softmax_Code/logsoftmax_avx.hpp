@@ -0,0 +1,61 @@
+#ifndef LOGSOFTMAX_AVX_HPP
+#define LOGSOFTMAX_AVX_HPP
+
+#include <cmath>
+#include <softmax_avx.hpp>
+
+// Maximum of input[0, K), any K >= 1
+inline float max_avx(const float *input, size_t K) {
+	const __m256 lowest = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	size_t K8 = K - (K % 8);
+	__m256i mask = tail_mask_avx(K % 8);
+	__m256 max_val = _mm256_blendv_ps(lowest, _mm256_maskload_ps(input + K8, mask), _mm256_castsi256_ps(mask));
+	for (size_t i = 0; i < K8; i += 8) {
+		max_val = _mm256_max_ps(max_val, _mm256_loadu_ps(input + i));
+	}
+	return hmax_avx(max_val);
+}
+
+// Sum of exp(input[i] - max) over [0, K), without storing the exponentials
+inline float expsum_avx(const float *input, size_t K, float max) {
+	size_t K8 = K - (K % 8);
+	__m256 max_vec = _mm256_set1_ps(max);
+	__m256 sum_vec = _mm256_setzero_ps();
+	for (size_t i = 0; i < K8; i += 8) {
+		sum_vec = _mm256_add_ps(sum_vec, exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(input + i), max_vec)));
+	}
+	if (K % 8 != 0) {
+		__m256i mask = tail_mask_avx(K % 8);
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_maskload_ps(input + K8, mask), max_vec));
+		sum_vec = _mm256_add_ps(sum_vec, _mm256_and_ps(exp_val, _mm256_castsi256_ps(mask)));
+	}
+	return hsum_avx(sum_vec);
+}
+
+// log(softmax(x))_i = x_i - (max + log(sum_j exp(x_j - max))).
+// The exponentials are only accumulated, never stored, and the output is
+// written once with a subtraction: no log per element.
+inline void log_softmax_avx(const float *input, float *output, size_t K) {
+	float max = max_avx(input, K);
+	float log_norm = max + std::log(expsum_avx(input, K, max));
+
+	size_t K8 = K - (K % 8);
+	__m256 norm_vec = _mm256_set1_ps(log_norm);
+	for (size_t i = 0; i < K8; i += 8) {
+		_mm256_storeu_ps(output + i, _mm256_sub_ps(_mm256_loadu_ps(input + i), norm_vec));
+	}
+	if (K % 8 != 0) {
+		__m256i mask = tail_mask_avx(K % 8);
+		_mm256_maskstore_ps(output + K8, mask, _mm256_sub_ps(_mm256_maskload_ps(input + K8, mask), norm_vec));
+	}
+}
+
+// Cross-entropy loss of the softmax of input with respect to the class label:
+// -log(softmax(x)_label) = max + log(sum_j exp(x_j - max)) - x_label.
+// Only the max and sum passes are needed, nothing is written to memory.
+inline float softmax_xent_avx(const float *input, size_t K, size_t label) {
+	float max = max_avx(input, K);
+	return max + std::log(expsum_avx(input, K, max)) - input[label];
+}
+
+#endif // LOGSOFTMAX_AVX_HPP
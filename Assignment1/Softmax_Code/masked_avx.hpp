@@ -0,0 +1,117 @@
+#ifndef MASKED_AVX_HPP
+#define MASKED_AVX_HPP
+
+#include <cstring>
+#include <softmax_avx.hpp>
+
+// Softmax of x / T with invalid positions excluded, in the same three passes
+// as softmax_avx: the temperature, the boolean mask (valid[i] != 0 keeps the
+// position) and the additive mask (bias[i] is added after the scaling, -inf
+// excludes the position) are applied while loading the logits, both in the
+// max and in the exp pass, instead of preparing a scaled/masked copy first.
+// Excluded positions get exactly 0 in the output; if all the positions are
+// excluded the output is all zeros.
+
+// Loads 8 logits from i, scaled and masked: excluded lanes are -inf.
+// If n < 8 only the first n are loaded and the others are excluded too.
+template <bool HasValid, bool HasBias>
+inline __m256 load_logits_avx(const float *input, const uint8_t *valid, const float *bias,
+							  size_t i, size_t n, __m256 inv_t) {
+	const __m256 neg_inf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+	__m256 x;
+	if (n == 8) {
+		x = _mm256_mul_ps(_mm256_loadu_ps(input + i), inv_t);
+		if constexpr (HasBias) {
+			x = _mm256_add_ps(x, _mm256_loadu_ps(bias + i));
+		}
+	} else {
+		__m256i mask = tail_mask_avx(n);
+		x = _mm256_mul_ps(_mm256_maskload_ps(input + i, mask), inv_t);
+		if constexpr (HasBias) {
+			x = _mm256_add_ps(x, _mm256_maskload_ps(bias + i, mask));
+		}
+		x = _mm256_blendv_ps(neg_inf, x, _mm256_castsi256_ps(mask));
+	}
+	if constexpr (HasValid) {
+		// 8 flags widened to 32-bit lanes, the tail through a buffer
+		uint64_t flags = 0;
+		std::memcpy(&flags, valid + i, n);
+		__m256i v = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(flags));
+		__m256 keep = _mm256_castsi256_ps(_mm256_cmpgt_epi32(v, _mm256_setzero_si256()));
+		x = _mm256_blendv_ps(neg_inf, x, keep);
+	}
+	return x;
+}
+
+// exp(x - max), with exactly 0 on the excluded (-inf) lanes: exp256_ps clamps
+// its argument and would return about 1e-38
+inline __m256 exp_logits_avx(__m256 x, __m256 max_vec) {
+	const __m256 neg_inf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+	__m256 valid = _mm256_cmp_ps(x, neg_inf, _CMP_NEQ_OQ);
+	return _mm256_and_ps(exp256_ps(_mm256_sub_ps(x, max_vec)), valid);
+}
+
+template <Normalize N, bool HasValid, bool HasBias>
+inline void softmax_masked_avx_impl(const float *input, float *output, size_t K, float temperature,
+									const uint8_t *valid, const float *bias) {
+	const __m256 inv_t = _mm256_set1_ps(1.0f / temperature);
+	size_t K8 = K - (K % 8);
+
+	// Find the maximum of the scaled, valid logits
+	__m256 max_val = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+	for (size_t i = 0; i < K8; i += 8) {
+		max_val = _mm256_max_ps(max_val, load_logits_avx<HasValid, HasBias>(input, valid, bias, i, 8, inv_t));
+	}
+	if (K % 8 != 0) {
+		max_val = _mm256_max_ps(max_val, load_logits_avx<HasValid, HasBias>(input, valid, bias, K8, K % 8, inv_t));
+	}
+	float max = hmax_avx(max_val);
+	if (max == -std::numeric_limits<float>::infinity()) {
+		std::memset(output, 0, K * sizeof(float));
+		return;
+	}
+	__m256 max_input_vec = _mm256_set1_ps(max);
+
+	// Computes all exponentials with the shift of max_val and the total sum
+	__m256 sum_vec = _mm256_setzero_ps();
+	for (size_t i = 0; i < K8; i += 8) {
+		__m256 exp_val = exp_logits_avx(load_logits_avx<HasValid, HasBias>(input, valid, bias, i, 8, inv_t), max_input_vec);
+		_mm256_storeu_ps(output + i, exp_val);
+		sum_vec = _mm256_add_ps(sum_vec, exp_val);
+	}
+	__m256i mask = tail_mask_avx(K % 8);
+	if (K % 8 != 0) {
+		__m256 exp_val = exp_logits_avx(load_logits_avx<HasValid, HasBias>(input, valid, bias, K8, K % 8, inv_t), max_input_vec);
+		_mm256_maskstore_ps(output + K8, mask, exp_val);
+		sum_vec = _mm256_add_ps(sum_vec, exp_val);
+	}
+
+	// Normalize by the total sum
+	__m256 sum_vect = norm_factor_avx<N>(hsum_avx(sum_vec));
+	for (size_t i = 0; i < K8; i += 8) {
+		_mm256_storeu_ps(output + i, normalize_avx<N>(_mm256_loadu_ps(output + i), sum_vect));
+	}
+	if (K % 8 != 0) {
+		__m256 output_val = _mm256_maskload_ps(output + K8, mask);
+		_mm256_maskstore_ps(output + K8, mask, normalize_avx<N>(output_val, sum_vect));
+	}
+}
+
+// softmax(x / temperature) over the positions with valid[i] != 0 (all if
+// valid is nullptr), with bias[i] added to the scaled logits if bias is not
+// nullptr. temperature must be positive.
+template <Normalize N = default_normalize>
+inline void softmax_masked_avx(const float *input, float *output, size_t K, float temperature = 1.0f,
+							   const uint8_t *valid = nullptr, const float *bias = nullptr) {
+	if (valid && bias) {
+		softmax_masked_avx_impl<N, true, true>(input, output, K, temperature, valid, bias);
+	} else if (valid) {
+		softmax_masked_avx_impl<N, true, false>(input, output, K, temperature, valid, bias);
+	} else if (bias) {
+		softmax_masked_avx_impl<N, false, true>(input, output, K, temperature, valid, bias);
+	} else {
+		softmax_masked_avx_impl<N, false, false>(input, output, K, temperature, valid, bias);
+	}
+}
+
+#endif // MASKED_AVX_HPP
@@ -0,0 +1,71 @@
+#ifndef ONLINE_AVX_HPP
+#define ONLINE_AVX_HPP
+
+#include <algorithm>
+#include <softmax_avx.hpp>
+
+// Online softmax: the maximum and the sum of the exponentials are computed in
+// the same read pass, keeping for each lane a running maximum and rescaling
+// the running sum by exp(old_max - new_max) every time the maximum changes.
+// To pay this extra exponential only once every 4 vectors, the running
+// maximum is updated with the maximum of a block of 32 elements.
+// The second pass recomputes the exponentials and writes the normalized
+// values, so the output is written only once and never read back.
+inline void softmax_online_avx(const float *input, float *output, size_t K) {
+	const __m256 lowest = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	size_t K32 = K - (K % 32);
+	size_t K8 = K - (K % 8);
+
+	__m256 max_vec = lowest;
+	__m256 sum_vec = _mm256_setzero_ps();
+
+	// Blocks of 4 vectors with a single rescale of the running sum
+	for (size_t i = 0; i < K32; i += 32) {
+		__m256 x0 = _mm256_loadu_ps(input + i);
+		__m256 x1 = _mm256_loadu_ps(input + i + 8);
+		__m256 x2 = _mm256_loadu_ps(input + i + 16);
+		__m256 x3 = _mm256_loadu_ps(input + i + 24);
+		__m256 block_max = _mm256_max_ps(_mm256_max_ps(x0, x1), _mm256_max_ps(x2, x3));
+		__m256 new_max = _mm256_max_ps(max_vec, block_max);
+
+		sum_vec = _mm256_mul_ps(sum_vec, exp256_ps(_mm256_sub_ps(max_vec, new_max)));
+		__m256 e01 = _mm256_add_ps(exp256_ps(_mm256_sub_ps(x0, new_max)),
+								   exp256_ps(_mm256_sub_ps(x1, new_max)));
+		__m256 e23 = _mm256_add_ps(exp256_ps(_mm256_sub_ps(x2, new_max)),
+								   exp256_ps(_mm256_sub_ps(x3, new_max)));
+		sum_vec = _mm256_add_ps(sum_vec, _mm256_add_ps(e01, e23));
+		max_vec = new_max;
+	}
+
+	// Remaining vectors and the masked tail, one at a time
+	for (size_t i = K32; i < K; i += 8) {
+		__m256i mask = tail_mask_avx(std::min<size_t>(8, K - i));
+		__m256 mask_ps = _mm256_castsi256_ps(mask);
+		__m256 x = _mm256_blendv_ps(lowest, _mm256_maskload_ps(input + i, mask), mask_ps);
+		__m256 new_max = _mm256_max_ps(max_vec, x);
+
+		sum_vec = _mm256_mul_ps(sum_vec, exp256_ps(_mm256_sub_ps(max_vec, new_max)));
+		__m256 e = _mm256_and_ps(exp256_ps(_mm256_sub_ps(x, new_max)), mask_ps);
+		sum_vec = _mm256_add_ps(sum_vec, e);
+		max_vec = new_max;
+	}
+
+	// Combine the lanes: rescale every lane sum to the global maximum
+	float max = hmax_avx(max_vec);
+	__m256 max_input_vec = _mm256_set1_ps(max);
+	sum_vec = _mm256_mul_ps(sum_vec, exp256_ps(_mm256_sub_ps(max_vec, max_input_vec)));
+	__m256 sum_vect = norm_factor_avx<default_normalize>(hsum_avx(sum_vec));
+
+	// Second pass: normalized exponentials, written only once
+	for (size_t i = 0; i < K8; i += 8) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(input + i), max_input_vec));
+		_mm256_storeu_ps(output + i, normalize_avx<default_normalize>(exp_val, sum_vect));
+	}
+	if (K % 8 != 0) {
+		__m256i mask = tail_mask_avx(K % 8);
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_maskload_ps(input + K8, mask), max_input_vec));
+		_mm256_maskstore_ps(output + K8, mask, normalize_avx<default_normalize>(exp_val, sum_vect));
+	}
+}
+
+#endif // ONLINE_AVX_HPP
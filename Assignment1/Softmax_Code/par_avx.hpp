@@ -0,0 +1,139 @@
+#ifndef PAR_AVX_HPP
+#define PAR_AVX_HPP
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <hpc_helpers.hpp>
+#include <softmax_avx.hpp>
+
+// Reusable barrier (std::barrier is only available from C++20)
+class Barrier {
+public:
+	explicit Barrier(int count) : count(count), waiting(0), generation(0) {}
+
+	void wait() {
+		std::unique_lock<std::mutex> lock(m);
+		int gen = generation;
+		if (++waiting == count) {
+			// The last thread arriving releases all the others
+			waiting = 0;
+			++generation;
+			cv.notify_all();
+		} else {
+			cv.wait(lock, [&] { return gen != generation; });
+		}
+	}
+
+private:
+	std::mutex m;
+	std::condition_variable cv;
+	int count;
+	int waiting;
+	int generation;
+};
+
+// Partial results of a thread, padded to a cache line to avoid false sharing
+struct alignas(64) Partial {
+	float max;
+	float sum;
+};
+
+// Maximum of input[begin, end)
+inline float max_range_avx(const float *input, size_t begin, size_t end) {
+	const __m256 lowest = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	size_t n = end - begin;
+	size_t body = begin + n - (n % 8);
+	__m256 max_val = lowest;
+	for (size_t i = begin; i < body; i += 8) {
+		max_val = _mm256_max_ps(max_val, _mm256_loadu_ps(input + i));
+	}
+	// Handle the case where n % 8 != 0, masked-out lanes are set to lowest
+	__m256i mask = tail_mask_avx(n % 8);
+	__m256 tail_val = _mm256_maskload_ps(input + body, mask);
+	max_val = _mm256_max_ps(max_val, _mm256_blendv_ps(lowest, tail_val, _mm256_castsi256_ps(mask)));
+	return hmax_avx(max_val);
+}
+
+// Writes exp(input[i] - max) in output[begin, end) and returns their sum
+inline float expsum_range_avx(const float *input, float *output, size_t begin, size_t end, float max) {
+	__m256 max_vec = _mm256_set1_ps(max);
+	__m256 sum_vec = _mm256_setzero_ps();
+	size_t n = end - begin;
+	size_t body = begin + n - (n % 8);
+	for (size_t i = begin; i < body; i += 8) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(input + i), max_vec));
+		_mm256_storeu_ps(output + i, exp_val);
+		sum_vec = _mm256_add_ps(sum_vec, exp_val);
+	}
+	if (n % 8 != 0) {
+		__m256i mask = tail_mask_avx(n % 8);
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_maskload_ps(input + body, mask), max_vec));
+		_mm256_maskstore_ps(output + body, mask, exp_val);
+		sum_vec = _mm256_add_ps(sum_vec, _mm256_and_ps(exp_val, _mm256_castsi256_ps(mask)));
+	}
+	return hsum_avx(sum_vec);
+}
+
+// Normalizes output[begin, end) by sum
+inline void normalize_range_avx(float *output, size_t begin, size_t end, float sum) {
+	__m256 sum_vec = norm_factor_avx<default_normalize>(sum);
+	size_t n = end - begin;
+	size_t body = begin + n - (n % 8);
+	for (size_t i = begin; i < body; i += 8) {
+		_mm256_storeu_ps(output + i, normalize_avx<default_normalize>(_mm256_loadu_ps(output + i), sum_vec));
+	}
+	if (n % 8 != 0) {
+		__m256i mask = tail_mask_avx(n % 8);
+		__m256 output_val = _mm256_maskload_ps(output + body, mask);
+		_mm256_maskstore_ps(output + body, mask, normalize_avx<default_normalize>(output_val, sum_vec));
+	}
+}
+
+// Multi-threaded softmax: each thread works on a contiguous block (a multiple
+// of 8 elements, except the last one) for all the three passes. The partial
+// maxima and sums are combined by every thread after a barrier, so no thread
+// has to wait for a single "master" to broadcast the result.
+inline void softmax_par_avx(const float *input, float *output, size_t K, int num_threads) {
+	std::vector<Partial> partials(num_threads);
+	Barrier barrier(num_threads);
+	size_t block = SDIV(SDIV(K, 8), (size_t)num_threads) * 8;
+
+	auto worker = [&](int id) {
+		size_t begin = std::min(K, id * block);
+		size_t end = std::min(K, begin + block);
+
+		// First pass: partial maximum, then combine
+		partials[id].max = max_range_avx(input, begin, end);
+		barrier.wait();
+		float max = std::numeric_limits<float>::lowest();
+		for (int t = 0; t < num_threads; ++t) {
+			max = std::max(max, partials[t].max);
+		}
+
+		// Second pass: exponentials and partial sum, then combine
+		partials[id].sum = expsum_range_avx(input, output, begin, end, max);
+		barrier.wait();
+		float sum = 0.0f;
+		for (int t = 0; t < num_threads; ++t) {
+			sum += partials[t].sum;
+		}
+
+		// Third pass: normalization
+		normalize_range_avx(output, begin, end, sum);
+	};
+
+	// The calling thread works as thread 0
+	std::vector<std::thread> threads;
+	for (int t = 1; t < num_threads; ++t) {
+		threads.emplace_back(worker, t);
+	}
+	worker(0);
+	for (auto &t : threads) {
+		t.join();
+	}
+}
+
+#endif // PAR_AVX_HPP
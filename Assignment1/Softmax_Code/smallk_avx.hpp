@@ -0,0 +1,104 @@
+#ifndef SMALLK_AVX_HPP
+#define SMALLK_AVX_HPP
+
+#include <array>
+#include <utility>
+#include <softmax_avx.hpp>
+
+// Softmax for a K known at compile time, for small vocabularies: the whole
+// input is kept in V = ceil(K/8) registers, the loops over the vectors have
+// constant trip count and are fully unrolled, and only the last vector is
+// masked (if K % 8 != 0). Max and sum are reduced with a tree over the
+// vectors instead of a serial chain.
+
+// Largest K with a specialized kernel (16 vectors)
+static const size_t SMALL_K_MAX = 128;
+
+// Pairwise reduction of V vectors into v[0]
+template <size_t V, typename Op>
+inline __m256 tree_reduce_avx(__m256 *v, Op op) {
+	#pragma GCC unroll 16
+	for (size_t s = 1; s < V; s *= 2) {
+		#pragma GCC unroll 16
+		for (size_t i = 0; i + s < V; i += 2 * s) {
+			v[i] = op(v[i], v[i + s]);
+		}
+	}
+	return v[0];
+}
+
+template <size_t K, Normalize N = default_normalize>
+inline void softmax_small_avx(const float *input, float *output) {
+	static_assert(K >= 1 && K <= SMALL_K_MAX, "K out of the small-K range");
+	constexpr size_t V = (K + 7) / 8;
+	constexpr size_t R = K % 8;    // elements in the last vector, 0 if full
+	const __m256i mask = tail_mask_avx(R);
+	const __m256 mask_ps = _mm256_castsi256_ps(mask);
+
+	// Only the full vectors are loaded unmasked: the last one would read
+	// past the end of input
+	constexpr size_t full = (R == 0) ? V : V - 1;
+	__m256 x[V], t[V];
+	#pragma GCC unroll 16
+	for (size_t v = 0; v < full; ++v) {
+		x[v] = _mm256_loadu_ps(input + 8 * v);
+	}
+	if constexpr (R != 0) {
+		x[V - 1] = _mm256_blendv_ps(_mm256_set1_ps(std::numeric_limits<float>::lowest()),
+									_mm256_maskload_ps(input + 8 * (V - 1), mask), mask_ps);
+	}
+
+	// Maximum
+	#pragma GCC unroll 16
+	for (size_t v = 0; v < V; ++v) {
+		t[v] = x[v];
+	}
+	float max = hmax_avx(tree_reduce_avx<V>(t, [](__m256 a, __m256 b) { return _mm256_max_ps(a, b); }));
+	__m256 max_input_vec = _mm256_set1_ps(max);
+
+	// Exponentials, kept in x, and their sum
+	#pragma GCC unroll 16
+	for (size_t v = 0; v < V; ++v) {
+		x[v] = exp256_ps(_mm256_sub_ps(x[v], max_input_vec));
+	}
+	if constexpr (R != 0) {
+		x[V - 1] = _mm256_and_ps(x[V - 1], mask_ps);
+	}
+	#pragma GCC unroll 16
+	for (size_t v = 0; v < V; ++v) {
+		t[v] = x[v];
+	}
+	float sum = hsum_avx(tree_reduce_avx<V>(t, [](__m256 a, __m256 b) { return _mm256_add_ps(a, b); }));
+
+	// Normalize and store
+	__m256 sum_vect = norm_factor_avx<N>(sum);
+	#pragma GCC unroll 16
+	for (size_t v = 0; v < full; ++v) {
+		_mm256_storeu_ps(output + 8 * v, normalize_avx<N>(x[v], sum_vect));
+	}
+	if constexpr (R != 0) {
+		_mm256_maskstore_ps(output + 8 * (V - 1), mask, normalize_avx<N>(x[V - 1], sum_vect));
+	}
+}
+
+using softmax_small_fn = void (*)(const float *, float *);
+
+// Table of the specialized kernels, entry K-1 for K in [1, SMALL_K_MAX]
+template <Normalize N, size_t... Ks>
+constexpr std::array<softmax_small_fn, sizeof...(Ks)> make_small_table(std::index_sequence<Ks...>) {
+	return {{softmax_small_avx<Ks + 1, N>...}};
+}
+
+// Runtime dispatch: specialized kernel for K <= SMALL_K_MAX, softmax_avx
+// otherwise
+template <Normalize N = default_normalize>
+inline void softmax_smallk_avx(const float *input, float *output, size_t K) {
+	static constexpr auto table = make_small_table<N>(std::make_index_sequence<SMALL_K_MAX>());
+	if (K >= 1 && K <= SMALL_K_MAX) {
+		table[K - 1](input, output);
+	} else {
+		softmax_avx<N>(input, output, K);
+	}
+}
+
+#endif // SMALLK_AVX_HPP
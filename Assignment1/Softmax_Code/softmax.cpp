@@ -0,0 +1,131 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <getopt.h>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <softmax_kernels.hpp>
+#include <random_fill.hpp>
+
+// Single driver for all the kernels of libsoftmax.a: the input is generated
+// once and every kernel given with --impl runs on it, so they can be compared
+// in the same process. With more than one kernel, the results are checked
+// against the first one.
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printResult(aligned_vector<float> &v, size_t K) {
+	for(size_t i=0; i<K; ++i) {
+		std::fprintf(stderr, "%f\n",v[i]);
+	}
+}
+
+void usage(const char *argv0) {
+	std::printf("use: %s [--impl name[,name...]] [--threads T] K [1]\n", argv0);
+	std::printf("kernels:");
+	for (const auto &kernel : softmax_kernels()) {
+		std::printf(" %s%s", kernel.name, kernel.supported ? "" : "(unsupported)");
+	}
+	std::printf("\n");
+}
+
+std::vector<std::string> split(const std::string &s) {
+	std::vector<std::string> items;
+	size_t start = 0, end;
+	while ((end = s.find(',', start)) != std::string::npos) {
+		items.push_back(s.substr(start, end - start));
+		start = end + 1;
+	}
+	items.push_back(s.substr(start));
+	return items;
+}
+
+
+int main(int argc, char *argv[]) {
+	std::vector<std::string> names{"avx"};
+	int num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	static const option long_options[] = {
+		{"impl", required_argument, nullptr, 'i'},
+		{"threads", required_argument, nullptr, 't'},
+		{nullptr, 0, nullptr, 0}
+	};
+	int c;
+	while ((c = getopt_long(argc, argv, "i:t:", long_options, nullptr)) != -1) {
+		switch (c) {
+			case 'i': names = split(optarg); break;
+			case 't': num_threads = std::atoi(optarg); break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	if (optind >= argc) {
+		usage(argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[optind]);
+	bool print = (optind + 1 < argc);
+	if (K == 0 || num_threads < 1) {
+		std::cerr << "Error: K and the number of threads must be positive" << std::endl;
+		return 1;
+	}
+
+	std::vector<const SoftmaxKernel *> kernels;
+	for (const auto &name : names) {
+		const SoftmaxKernel *kernel = find_softmax_kernel(name);
+		if (!kernel || !kernel->supported) {
+			std::cerr << "Error: kernel " << name << (kernel ? " not supported by this CPU" : " unknown") << std::endl;
+			return 1;
+		}
+		kernels.push_back(kernel);
+	}
+
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(K);
+	aligned_vector<float> output(K);
+	aligned_vector<float> first(kernels.size() > 1 ? K : 0);
+
+	for (size_t k = 0; k < kernels.size(); ++k) {
+		const SoftmaxKernel *kernel = kernels[k];
+		// Same output as TIMERSTART/TIMERSTOP, with the label softime_<name>;
+		// the counters cover only the kernel call
+		const std::string label = std::string("softime_") + kernel->name;
+		PERFSTART(softime);
+		auto start = std::chrono::steady_clock::now();
+		kernel->fn(input.data(), output.data(), K, num_threads);
+		auto stop = std::chrono::steady_clock::now();
+		PERFSTOP_NAMED(softime, label.c_str(), K);
+		std::chrono::duration<double> elapsed = stop - start;
+		std::cout << "# elapsed time (" << label << "): " << elapsed.count() << "s" << std::endl;
+		timer_registry::instance().record(label, stop - start);
+
+		if (k == 0 && kernels.size() > 1) {
+			first = output;
+		} else if (k > 0) {
+			float max_diff = 0.0f, max_rel = 0.0f;
+			for (size_t i = 0; i < K; ++i) {
+				max_diff = std::max(max_diff, std::abs(output[i] - first[i]));
+				if (first[i] != 0.0f) {
+					max_rel = std::max(max_rel, std::abs(output[i] - first[i]) / first[i]);
+				}
+			}
+			std::cout << "# max abs difference (" << kernel->name << " vs " << kernels[0]->name << "): " << max_diff << std::endl;
+			std::cout << "# max rel difference (" << kernel->name << " vs " << kernels[0]->name << "): " << max_rel << std::endl;
+		}
+	}
+
+	// print the results of the last kernel on the standard output
+	if (print) {
+		printResult(output, K);
+	}
+}
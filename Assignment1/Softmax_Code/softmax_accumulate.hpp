@@ -0,0 +1,29 @@
+#ifndef SOFTMAX_ACCUMULATE_HPP
+#define SOFTMAX_ACCUMULATE_HPP
+
+#include <cstddef>
+
+// How the sum of the exponentials is accumulated:
+//  - flt:     a float accumulator (8 float lanes in the AVX kernels), the
+//             rounding error grows linearly with K
+//  - kahan:   compensated summation, an extra float (vector) keeps the lost
+//             low-order bits. Not available in softmax_auto: -ffast-math lets
+//             the compiler simplify the compensation away
+//  - blocked: float partial sums of ACCUMULATE_BLOCK elements (per lane),
+//             added to the total at the end of every block
+//  - f64:     a double accumulator (also used by softmax_auto when kahan is
+//             the default)
+enum class Accumulate { flt, kahan, blocked, f64 };
+
+// Mode used by the kernels when not given explicitly, it can be changed at
+// compile time with -DSOFTMAX_ACCUMULATE=flt|kahan|blocked|f64
+#ifndef SOFTMAX_ACCUMULATE
+#define SOFTMAX_ACCUMULATE flt
+#endif
+
+constexpr Accumulate default_accumulate = Accumulate::SOFTMAX_ACCUMULATE;
+
+// Elements (per lane in the AVX kernels) of a block of Accumulate::blocked
+constexpr size_t ACCUMULATE_BLOCK = 256;
+
+#endif // SOFTMAX_ACCUMULATE_HPP
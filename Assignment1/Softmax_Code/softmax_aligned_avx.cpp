@@ -0,0 +1,65 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <softmax_avx.hpp>
+#include <random_fill.hpp>
+
+// Effect of the buffer allocation on softmax_avx for large K: buffers
+// misaligned on purpose (unaligned loads/stores, vectors split across cache
+// lines), 64-byte aligned buffers (aligned loads/stores), and 64-byte aligned
+// buffers backed by transparent huge pages. Best time over reps calls.
+
+template <typename Vector>
+double best_time(const Vector &input, Vector &output, size_t offset, size_t K, int reps) {
+	double best = std::numeric_limits<double>::max();
+	for (int r = 0; r < reps; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		softmax_avx(input.data() + offset, output.data() + offset, K);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+template <typename Vector>
+void fill_random(Vector &v, float min = -1.0f, float max = 1.0f) {
+	random_fill_uniform(v.data(), v.size(), 5489, min, max); // fixed seed for reproducible results
+}
+
+void printTime(const char *label, double seconds, size_t K) {
+	// input read twice, output written twice and read once
+	double bytes = 5.0 * K * sizeof(float);
+	std::printf("%-20s %14.6e s %8.2f GB/s\n", label, seconds, bytes / seconds / 1e9);
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [reps]\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	int reps = (argc >= 3) ? std::stoi(argv[2]) : 5;
+
+	{
+		// One extra float, the data start 4 bytes after an aligned address
+		aligned_vector<float> input(K + 1), output(K + 1);
+		fill_random(input);
+		printTime("misaligned", best_time(input, output, 1, K, reps), K);
+	}
+	{
+		use_huge_pages = false;
+		aligned_vector<float> input(K), output(K);
+		fill_random(input);
+		printTime("aligned", best_time(input, output, 0, K, reps), K);
+	}
+	{
+		use_huge_pages = true;
+		aligned_vector<float> input(K), output(K);
+		fill_random(input);
+		printTime("aligned+hugepages", best_time(input, output, 0, K, reps), K);
+	}
+}
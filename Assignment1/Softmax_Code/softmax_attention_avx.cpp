@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <attention_avx.hpp>
+#include <random_fill.hpp>
+
+// Timing of attention_flash_avx (tiled, online softmax) against
+// attention_naive_avx (matmul + softmax_avx + matmul, with the full score
+// matrix in memory), on random Q, K, V in [-1, 1].
+// Both are checked against a scalar reference in double on a sample of
+// queries; returns 1 if the results differ more than the tolerance.
+
+// Output row i of the attention, computed in double
+void attention_row_ref(const float *Q, const float *K, const float *V, size_t i, size_t M, size_t d, size_t dv,
+					   std::vector<double> &out) {
+	std::vector<double> s(M);
+	double max_val = -std::numeric_limits<double>::infinity();
+	for (size_t j = 0; j < M; ++j) {
+		double dot = 0.0;
+		for (size_t k = 0; k < d; ++k) {
+			dot += (double)Q[i * d + k] * K[j * d + k];
+		}
+		s[j] = dot / std::sqrt((double)d);
+		max_val = std::max(max_val, s[j]);
+	}
+	double sum = 0.0;
+	std::fill(out.begin(), out.end(), 0.0);
+	for (size_t j = 0; j < M; ++j) {
+		double p = std::exp(s[j] - max_val);
+		sum += p;
+		for (size_t c = 0; c < dv; ++c) {
+			out[c] += p * V[j * dv + c];
+		}
+	}
+	for (size_t c = 0; c < dv; ++c) {
+		out[c] /= sum;
+	}
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f, unsigned seed = 5489) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, seed, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		std::printf("use: %s N M [d] [threads]\n", argv[0]);
+		return 0;
+	}
+	size_t N = std::stol(argv[1]);
+	size_t M = std::stol(argv[2]);
+	size_t d = (argc >= 4) ? std::stol(argv[3]) : 64;
+	int num_threads = (argc >= 5) ? std::stoi(argv[4]) : 1;
+	size_t dv = d;
+	if (N == 0 || M == 0 || d == 0 || num_threads < 1) {
+		std::cerr << "Error: N, M, d and the number of threads must be positive" << std::endl;
+		return 1;
+	}
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> Q=generate_random_input(N * d);
+	aligned_vector<float> K=generate_random_input(M * d, -1.0f, 1.0f, 42);
+	aligned_vector<float> V=generate_random_input(M * dv, -1.0f, 1.0f, 4242);
+	aligned_vector<float> O_naive(N * dv), O_flash(N * dv);
+
+	TIMERSTART(softime_attention_naive);
+	attention_naive_avx(Q.data(), K.data(), V.data(), O_naive.data(), N, M, d, dv, num_threads);
+	TIMERSTOP(softime_attention_naive);
+
+	TIMERSTART(softime_attention_flash);
+	attention_flash_avx(Q.data(), K.data(), V.data(), O_flash.data(), N, M, d, dv, num_threads);
+	TIMERSTOP(softime_attention_flash);
+
+	// 2 N M d flops for Q K^T and 2 N M dv for P V
+	double flops = 2.0 * N * M * (d + dv);
+	std::cout << "# score matrix of the naive version: " << N * SDIV(M, 8) * 8 * sizeof(float) / 1e6 << " MB" << std::endl;
+	std::cout << "# GFLOP/s (naive): " << flops / deltasoftime_attention_naive.count() / 1e9 << std::endl;
+	std::cout << "# GFLOP/s (flash): " << flops / deltasoftime_attention_flash.count() / 1e9 << std::endl;
+	std::cout << "# speedup (softime_attention_naive/softime_attention_flash): "
+			  << deltasoftime_attention_naive.count() / deltasoftime_attention_flash.count() << std::endl;
+
+	float diff = 0.0f;
+	for (size_t i = 0; i < N * dv; ++i) {
+		diff = std::max(diff, std::abs(O_flash[i] - O_naive[i]));
+	}
+	std::cout << "# max abs difference (flash vs naive): " << diff << std::endl;
+
+	// Reference on 16 queries spread over the whole range
+	std::vector<double> ref(dv);
+	float diff_naive = 0.0f, diff_flash = 0.0f;
+	for (size_t t = 0; t < std::min<size_t>(N, 16); ++t) {
+		size_t i = t * (N - 1) / std::max<size_t>(1, std::min<size_t>(N, 16) - 1);
+		attention_row_ref(Q.data(), K.data(), V.data(), i, M, d, dv, ref);
+		for (size_t c = 0; c < dv; ++c) {
+			diff_naive = std::max(diff_naive, (float)std::abs(O_naive[i * dv + c] - ref[c]));
+			diff_flash = std::max(diff_flash, (float)std::abs(O_flash[i * dv + c] - ref[c]));
+		}
+	}
+	std::cout << "# max abs difference (naive vs ref): " << diff_naive << std::endl;
+	std::cout << "# max abs difference (flash vs ref): " << diff_flash << std::endl;
+
+	// The outputs are averages of values in [-1, 1]
+	const float tolerance = 1e-4f;
+	if (diff_naive > tolerance || diff_flash > tolerance) {
+		std::cerr << "Error: check against the scalar reference failed" << std::endl;
+		return 1;
+	}
+}
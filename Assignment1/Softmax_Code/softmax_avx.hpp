@@ -0,0 +1,270 @@
+#ifndef SOFTMAX_AVX_HPP
+#define SOFTMAX_AVX_HPP
+
+#include <limits>
+#include <cstdint>
+#include <avx_mathfun.h>
+#include <softmax_normalize.hpp>
+#include <softmax_accumulate.hpp>
+
+// Sum of the elements of a vector
+inline float hsum_sse3(__m128 v) {
+	__m128 shuf = _mm_movehdup_ps(v);
+	__m128 maxs = _mm_add_ps(v, shuf);
+	shuf = _mm_movehl_ps(shuf, maxs);
+	maxs = _mm_add_ss(maxs, shuf);
+	return _mm_cvtss_f32(maxs);
+} 
+
+
+inline float hsum_avx(__m256 v) {
+	__m128 lo = _mm256_castps256_ps128(v); 
+	__m128 hi = _mm256_extractf128_ps(v, 1);
+	lo = _mm_add_ps(lo, hi);
+	return hsum_sse3(lo); 
+}
+
+// Maximum of the elements of a vector
+inline float hmax_sse3(__m128 v) {
+	__m128 shuf = _mm_movehdup_ps(v);
+	__m128 maxs = _mm_max_ps(v, shuf);
+	shuf = _mm_movehl_ps(shuf, maxs);
+	maxs = _mm_max_ss(maxs, shuf);
+	return _mm_cvtss_f32(maxs);
+}
+
+inline float hmax_avx(__m256 v) {
+	__m128 lo = _mm256_castps256_ps128(v); 
+	__m128 hi = _mm256_extractf128_ps(v, 1);
+	lo = _mm_max_ps(lo, hi);
+	return hmax_sse3(lo); 
+}
+
+// Mask with the first n lanes (0 <= n <= 8) set, obtained by sliding an
+// 8-wide window over a constant table: no per-lane compares are needed
+alignas(32) static const int tail_mask_table[16] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+inline __m256i tail_mask_avx(size_t n) {
+	return _mm256_loadu_si256((const __m256i*)(tail_mask_table + 8 - n));
+}
+
+// Vector the exponentials are divided (Normalize::div) or multiplied by
+template <Normalize N>
+inline __m256 norm_factor_avx(float sum) {
+	if constexpr (N == Normalize::div) {
+		return _mm256_set1_ps(sum);
+	} else if constexpr (N == Normalize::rcp) {
+		return _mm256_set1_ps(1.0f / sum);
+	} else {
+		// 12-bit approximation, refined with r = r * (2 - sum * r)
+		__m256 s = _mm256_set1_ps(sum);
+		__m256 r = _mm256_rcp_ps(s);
+		return _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(s, r)));
+	}
+}
+
+template <Normalize N>
+inline __m256 normalize_avx(__m256 v, __m256 factor) {
+	if constexpr (N == Normalize::div) {
+		return _mm256_div_ps(v, factor);
+	} else {
+		return _mm256_mul_ps(v, factor);
+	}
+}
+
+// Accumulator of the sum of the exponentials, see softmax_accumulate.hpp
+template <Accumulate A>
+struct SumAvx;
+
+template <>
+struct SumAvx<Accumulate::flt> {
+	__m256 sum = _mm256_setzero_ps();
+	void add(__m256 v) { sum = _mm256_add_ps(sum, v); }
+	float result() const { return hsum_avx(sum); }
+};
+
+template <>
+struct SumAvx<Accumulate::kahan> {
+	__m256 sum = _mm256_setzero_ps();
+	__m256 c = _mm256_setzero_ps();
+	void add(__m256 v) {
+		__m256 y = _mm256_sub_ps(v, c);
+		__m256 t = _mm256_add_ps(sum, y);
+		c = _mm256_sub_ps(_mm256_sub_ps(t, sum), y);
+		sum = t;
+	}
+	float result() const { return hsum_avx(_mm256_sub_ps(sum, c)); }
+};
+
+template <>
+struct SumAvx<Accumulate::blocked> {
+	__m256 sum = _mm256_setzero_ps();
+	__m256 block = _mm256_setzero_ps();
+	size_t count = 0;
+	void add(__m256 v) {
+		block = _mm256_add_ps(block, v);
+		if (++count == ACCUMULATE_BLOCK) {
+			sum = _mm256_add_ps(sum, block);
+			block = _mm256_setzero_ps();
+			count = 0;
+		}
+	}
+	float result() const { return hsum_avx(_mm256_add_ps(sum, block)); }
+};
+
+template <>
+struct SumAvx<Accumulate::f64> {
+	__m256d lo = _mm256_setzero_pd();
+	__m256d hi = _mm256_setzero_pd();
+	void add(__m256 v) {
+		lo = _mm256_add_pd(lo, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+		hi = _mm256_add_pd(hi, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+	}
+	float result() const {
+		alignas(32) double parts[4];
+		_mm256_store_pd(parts, _mm256_add_pd(lo, hi));
+		return (parts[0] + parts[1]) + (parts[2] + parts[3]);
+	}
+};
+
+// Aligned or unaligned load/store, chosen at compile time
+template <bool Aligned>
+inline __m256 load_avx(const float *p) {
+	if constexpr (Aligned) {
+		return _mm256_load_ps(p);
+	} else {
+		return _mm256_loadu_ps(p);
+	}
+}
+
+template <bool Aligned>
+inline void store_avx(float *p, __m256 v) {
+	if constexpr (Aligned) {
+		_mm256_store_ps(p, v);
+	} else {
+		_mm256_storeu_ps(p, v);
+	}
+}
+
+template <Normalize N, Accumulate A, bool Aligned>
+inline void softmax_avx_impl(const float *input, float *output, size_t K) {
+
+	// Assuming that K is greater than 8
+	size_t Kminus7 = K - 7;
+
+    // Find the maximum to stabilize the computation of the exponential
+	__m256 max_val = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	for (size_t i = 0; i < Kminus7; i += 8) {
+		__m256 input_val = load_avx<Aligned>(input + i);
+		max_val = _mm256_max_ps(max_val, input_val);
+	}
+	// Handle the case where K % 8 != 0
+	max_val=_mm256_max_ps(_mm256_loadu_ps(input + K-8), max_val);
+
+	// hmax_avx implementation
+	float max = hmax_avx(max_val);
+
+	// Computes all exponentials with the shift of max_val and the total sum
+	SumAvx<A> sum_vec;
+	__m256 max_input_vec = _mm256_set1_ps(max);
+	for (size_t i = 0; i < Kminus7; i += 8) {
+		__m256 input_val = load_avx<Aligned>(input + i);
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(input_val, max_input_vec));
+		store_avx<Aligned>(output + i, exp_val);
+		sum_vec.add(exp_val);
+	}
+
+	// Handle the case where K % 8 != 0 using masks
+	if (K % 8 != 0) {
+		size_t remainder_start = K - (K % 8);
+
+		// Create a mask to indicate the position to consider
+		__m256i mask = _mm256_set_epi32(
+			(remainder_start + 7 < K) ? -1 : 0,
+			(remainder_start + 6 < K) ? -1 : 0,
+			(remainder_start + 5 < K) ? -1 : 0,
+			(remainder_start + 4 < K) ? -1 : 0,
+			(remainder_start + 3 < K) ? -1 : 0,
+			(remainder_start + 2 < K) ? -1 : 0,
+			(remainder_start + 1 < K) ? -1 : 0,
+			(remainder_start + 0 < K) ? -1 : 0
+		);
+
+		int mask_array[8];
+		_mm256_storeu_si256((__m256i*)mask_array, mask);
+
+		__m256 input_val = _mm256_maskload_ps(input + remainder_start, mask);
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(input_val, max_input_vec));
+		
+		_mm256_maskstore_ps(output + remainder_start, mask, exp_val);
+
+		// use the mask to indicate the correct elementes to be summed
+		__m256 mask_sum = _mm256_and_ps(exp_val, _mm256_castsi256_ps(mask));
+		sum_vec.add(mask_sum);
+
+		// Another way to use the mask using FMA (doesn't work on backends nodes
+		// that don't support FMA)
+
+		// __m256 mask_fma = _mm256_and_ps(_mm256_castsi256_ps(mask), _mm256_set1_ps(1.0f));
+        // sum_vec = _mm256_fmadd_ps(exp_val, mask_fma, sum_vec);
+	}
+
+	// hsum_avx implementation
+	float sum = sum_vec.result();
+
+	// Normalize by the total sum
+	__m256 sum_vect = norm_factor_avx<N>(sum);
+	for (size_t i = 0; i < Kminus7; i += 8) {
+		__m256 output_val = load_avx<Aligned>(output + i);
+		output_val = normalize_avx<N>(output_val, sum_vect);
+		store_avx<Aligned>(output + i, output_val);
+	}
+
+	// Handle the case where K % 8 != 0 using masks
+	if (K % 8 != 0) {
+		size_t remainder_start = K - (K % 8);
+		__m256i mask = _mm256_set_epi32(
+			(remainder_start + 7 < K) ? -1 : 0,
+			(remainder_start + 6 < K) ? -1 : 0,
+			(remainder_start + 5 < K) ? -1 : 0,
+			(remainder_start + 4 < K) ? -1 : 0,
+			(remainder_start + 3 < K) ? -1 : 0,
+			(remainder_start + 2 < K) ? -1 : 0,
+			(remainder_start + 1 < K) ? -1 : 0,
+			(remainder_start + 0 < K) ? -1 : 0
+		);
+		__m256 output_val = _mm256_maskload_ps(output + remainder_start, mask);
+		output_val = normalize_avx<N>(output_val, sum_vect);
+		_mm256_maskstore_ps(output + remainder_start, mask, output_val);
+	}
+}
+
+// K < 8: a single masked vector (softmax_avx_impl would underflow K - 7)
+template <Normalize N>
+inline void softmax_short_avx(const float *input, float *output, size_t K) {
+	__m256i mask = tail_mask_avx(K);
+	__m256 mask_ps = _mm256_castsi256_ps(mask);
+	__m256 lowest = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	__m256 input_val = _mm256_blendv_ps(lowest, _mm256_maskload_ps(input, mask), mask_ps);
+	__m256 max_input_vec = _mm256_set1_ps(hmax_avx(input_val));
+	__m256 exp_val = _mm256_and_ps(exp256_ps(_mm256_sub_ps(input_val, max_input_vec)), mask_ps);
+	__m256 sum_vect = norm_factor_avx<N>(hsum_avx(exp_val));
+	_mm256_maskstore_ps(output, mask, normalize_avx<N>(exp_val, sum_vect));
+}
+
+// Uses aligned loads and stores in the main loops when both input and output
+// are 32-byte aligned (e.g. allocated with aligned_allocator.hpp)
+template <Normalize N = default_normalize, Accumulate A = default_accumulate>
+inline void softmax_avx(const float *input, float *output, size_t K) {
+	if (K < 8) {
+		softmax_short_avx<N>(input, output, K);
+	} else if ((((uintptr_t)input | (uintptr_t)output) & 31) == 0) {
+		softmax_avx_impl<N, A, true>(input, output, K);
+	} else {
+		softmax_avx_impl<N, A, false>(input, output, K);
+	}
+}
+
+#endif // SOFTMAX_AVX_HPP
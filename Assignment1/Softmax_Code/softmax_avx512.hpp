@@ -0,0 +1,100 @@
+#ifndef SOFTMAX_AVX512_HPP
+#define SOFTMAX_AVX512_HPP
+
+#include <limits>
+#include <immintrin.h>
+#include <softmax_normalize.hpp>
+
+// 16-wide version of exp256_ps (Cephes polynomial, same constants as
+// avx_mathfun.h). The final multiplication by 2^n is done with scalef,
+// which also takes care of the range of n.
+inline __m512 exp512_ps(__m512 x) {
+	x = _mm512_min_ps(x, _mm512_set1_ps(88.3762626647949f));
+	x = _mm512_max_ps(x, _mm512_set1_ps(-88.3762626647949f));
+
+	// express exp(x) as exp(g + n*log(2))
+	__m512 fx = _mm512_fmadd_ps(x, _mm512_set1_ps(1.44269504088896341f), _mm512_set1_ps(0.5f));
+	fx = _mm512_roundscale_ps(fx, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+
+	x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(0.693359375f), x);
+	x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(-2.12194440e-4f), x);
+
+	__m512 z = _mm512_mul_ps(x, x);
+	__m512 y = _mm512_set1_ps(1.9875691500E-4f);
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(1.3981999507E-3f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(8.3334519073E-3f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(4.1665795894E-2f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(1.6666665459E-1f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(5.0000001201E-1f));
+	y = _mm512_fmadd_ps(y, z, x);
+	y = _mm512_add_ps(y, _mm512_set1_ps(1.0f));
+
+	// y * 2^n
+	return _mm512_scalef_ps(y, fx);
+}
+
+// Mask with the first n lanes (0 <= n <= 16) set
+inline __mmask16 tail_mask_avx512(size_t n) {
+	return (__mmask16)((1u << n) - 1);
+}
+
+// Vector the exponentials are divided (Normalize::div) or multiplied by
+template <Normalize N>
+inline __m512 norm_factor_avx512(float sum) {
+	if constexpr (N == Normalize::div) {
+		return _mm512_set1_ps(sum);
+	} else if constexpr (N == Normalize::rcp) {
+		return _mm512_set1_ps(1.0f / sum);
+	} else {
+		// 14-bit approximation, refined with r = r * (2 - sum * r)
+		__m512 s = _mm512_set1_ps(sum);
+		__m512 r = _mm512_rcp14_ps(s);
+		return _mm512_mul_ps(r, _mm512_fnmadd_ps(s, r, _mm512_set1_ps(2.0f)));
+	}
+}
+
+template <Normalize N>
+inline __m512 normalize_avx512(__m512 v, __m512 factor) {
+	if constexpr (N == Normalize::div) {
+		return _mm512_div_ps(v, factor);
+	} else {
+		return _mm512_mul_ps(v, factor);
+	}
+}
+
+// Same three passes as softmax_avx, on 16 floats at a time. The tail is
+// handled with mask registers, so there is no restriction on K.
+template <Normalize N = default_normalize>
+inline void softmax_avx512(const float *input, float *output, size_t K) {
+	const __m512 lowest = _mm512_set1_ps(std::numeric_limits<float>::lowest());
+	size_t K16 = K - (K % 16);
+	__mmask16 mask = tail_mask_avx512(K % 16);
+
+	// Find the maximum to stabilize the computation of the exponential,
+	// masked-out lanes of the tail are loaded as lowest
+	__m512 max_val = _mm512_mask_loadu_ps(lowest, mask, input + K16);
+	for (size_t i = 0; i < K16; i += 16) {
+		max_val = _mm512_max_ps(max_val, _mm512_loadu_ps(input + i));
+	}
+	__m512 max_input_vec = _mm512_set1_ps(_mm512_reduce_max_ps(max_val));
+
+	// Computes all exponentials with the shift of max_val and the total sum
+	__m512 sum_vec = _mm512_setzero_ps();
+	for (size_t i = 0; i < K16; i += 16) {
+		__m512 exp_val = exp512_ps(_mm512_sub_ps(_mm512_loadu_ps(input + i), max_input_vec));
+		_mm512_storeu_ps(output + i, exp_val);
+		sum_vec = _mm512_add_ps(sum_vec, exp_val);
+	}
+	__m512 exp_tail = exp512_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, input + K16), max_input_vec));
+	_mm512_mask_storeu_ps(output + K16, mask, exp_tail);
+	sum_vec = _mm512_mask_add_ps(sum_vec, mask, sum_vec, exp_tail);
+
+	// Normalize by the total sum
+	__m512 sum_vect = norm_factor_avx512<N>(_mm512_reduce_add_ps(sum_vec));
+	for (size_t i = 0; i < K16; i += 16) {
+		_mm512_storeu_ps(output + i, normalize_avx512<N>(_mm512_loadu_ps(output + i), sum_vect));
+	}
+	_mm512_mask_storeu_ps(output + K16, mask, normalize_avx512<N>(exp_tail, sum_vect));
+}
+
+#endif // SOFTMAX_AVX512_HPP
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <chrono>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <backward_avx.hpp>
+#include <random_fill.hpp>
+#include <softmax_kernels.hpp>
+
+// Parity check and timing of softmax_backward_avx, softmax_backward_par_avx
+// and softmax_backward_batched_avx against a scalar backward pass, on the
+// output of the plain_f64 kernel of libsoftmax.a and a random upstream
+// gradient dy, also in place (dx aliasing dy). The times are medians of
+// repeated calls after a warm-up one. Returns 1 if the results differ more
+// than the tolerance.
+
+// Scalar backward pass, the dot product accumulated in double
+void softmax_backward_plain(const float *y, const float *dy, float *dx, size_t K) {
+	double dot = 0.0;
+	for (size_t i = 0; i < K; ++i) {
+		dot += (double)y[i] * dy[i];
+	}
+	for (size_t i = 0; i < K; ++i) {
+		dx[i] = y[i] * (dy[i] - (float)dot);
+	}
+}
+
+// Median time in seconds of reps calls of f, after one call to warm up the
+// caches and fault in the pages
+template <typename F>
+double median_time(F f, int reps = 11) {
+	f();
+	std::vector<double> times;
+	for (int i = 0; i < reps; ++i) {
+		auto a = std::chrono::steady_clock::now();
+		f();
+		auto b = std::chrono::steady_clock::now();
+		times.push_back(std::chrono::duration<double>(b - a).count());
+	}
+	std::nth_element(times.begin(), times.begin() + reps / 2, times.end());
+	return times[reps / 2];
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f, unsigned seed = 5489) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, seed, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printResult(aligned_vector<float> &v, size_t K) {
+	for(size_t i=0; i<K; ++i) {
+		std::fprintf(stderr, "%f\n",v[i]);
+	}
+}
+
+// Max abs difference, relative to the largest gradient of the reference:
+// the single dx[i] are of order 1/K, their absolute error is meaningless
+float max_norm_diff(const aligned_vector<float> &a, const aligned_vector<float> &ref) {
+	float diff = 0.0f, scale = 0.0f;
+	for (size_t i = 0; i < ref.size(); ++i) {
+		diff = std::max(diff, std::abs(a[i] - ref[i]));
+		scale = std::max(scale, std::abs(ref[i]));
+	}
+	return scale > 0.0f ? diff / scale : diff;
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [threads] [rows] [1]\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	int num_threads = (argc >= 3) ? std::stoi(argv[2]) : 4;
+	size_t rows = (argc >= 4) ? std::stol(argv[3]) : 0;
+	bool print=false;
+	if (argc == 5) {
+		print=true;
+	}
+	if (K == 0 || num_threads < 1) {
+		std::cerr << "Error: K and the number of threads must be positive" << std::endl;
+		return 1;
+	}
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(K);
+	aligned_vector<float> dy=generate_random_input(K, -1.0f, 1.0f, 42);
+	aligned_vector<float> y(K), ref(K), dx(K), dx_par(K);
+	softmax_kernel_plain_acc<Accumulate::f64>(input.data(), y.data(), K);
+
+	double time_plain = median_time([&] {
+		softmax_backward_plain(y.data(), dy.data(), ref.data(), K);
+	});
+	double time_avx = median_time([&] {
+		softmax_backward_avx(y.data(), dy.data(), dx.data(), K);
+	});
+	double time_par = median_time([&] {
+		softmax_backward_par_avx(y.data(), dy.data(), dx_par.data(), K, num_threads);
+	});
+	std::cout << "# elapsed time (softime_backward_plain): " << time_plain << "s" << std::endl;
+	std::cout << "# elapsed time (softime_backward_avx): " << time_avx << "s" << std::endl;
+	std::cout << "# elapsed time (softime_backward_par): " << time_par << "s" << std::endl;
+	std::cout << "# speedup (softime_backward_plain/softime_backward_avx): " << time_plain / time_avx << std::endl;
+	std::cout << "# speedup (softime_backward_avx/softime_backward_par): " << time_avx / time_par << std::endl;
+
+	// In place: the gradient overwrites a copy of dy
+	aligned_vector<float> dx_inplace(dy), dx_par_inplace(dy);
+	softmax_backward_avx(y.data(), dx_inplace.data(), dx_inplace.data(), K);
+	softmax_backward_par_avx(y.data(), dx_par_inplace.data(), dx_par_inplace.data(), K, num_threads);
+
+	float diff = max_norm_diff(dx, ref);
+	float diff_par = max_norm_diff(dx_par, ref);
+	float diff_inplace = std::max(max_norm_diff(dx_inplace, ref), max_norm_diff(dx_par_inplace, ref));
+	std::cout << "# max normalized difference (backward_avx vs plain): " << diff << std::endl;
+	std::cout << "# max normalized difference (backward_par vs plain): " << diff_par << std::endl;
+	std::cout << "# max normalized difference (in place vs plain): " << diff_inplace << std::endl;
+
+	// Batched form on rows independent rows of K elements
+	float diff_batched = 0.0f;
+	if (rows > 0) {
+		aligned_vector<float> batch_input=generate_random_input(rows * K);
+		aligned_vector<float> batch_dy=generate_random_input(rows * K, -1.0f, 1.0f, 42);
+		aligned_vector<float> batch_y(rows * K), batch_ref(rows * K), batch_dx(rows * K);
+		for (size_t r = 0; r < rows; ++r) {
+			softmax_kernel_plain_acc<Accumulate::f64>(batch_input.data() + r * K, batch_y.data() + r * K, K);
+		}
+
+		double time_batched_plain = median_time([&] {
+			for (size_t r = 0; r < rows; ++r) {
+				softmax_backward_plain(batch_y.data() + r * K, batch_dy.data() + r * K, batch_ref.data() + r * K, K);
+			}
+		});
+		double time_batched = median_time([&] {
+			softmax_backward_batched_avx(batch_y.data(), batch_dy.data(), batch_dx.data(), rows, K, K, num_threads);
+		});
+		std::cout << "# elapsed time (softime_backward_batched_plain): " << time_batched_plain << "s" << std::endl;
+		std::cout << "# elapsed time (softime_backward_batched): " << time_batched << "s" << std::endl;
+		std::cout << "# speedup (softime_backward_batched_plain/softime_backward_batched): "
+				  << time_batched_plain / time_batched << std::endl;
+
+		diff_batched = max_norm_diff(batch_dx, batch_ref);
+		std::cout << "# max normalized difference (backward_batched vs plain): " << diff_batched << std::endl;
+	}
+
+	// print the results on the standard output
+	if (print) {
+		printResult(dx, K);
+	}
+
+	// The float lane sums of the dot product drift linearly with K, as in
+	// softmax_log_avx: scale the tolerance with it
+	const float tolerance = 1e-4f * std::max(1.0f, K / float(1 << 20));
+	if (diff > tolerance || diff_par > tolerance || diff_inplace > tolerance || diff_batched > tolerance) {
+		std::cerr << "Error: parity check against the scalar backward pass failed" << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,193 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <softmax_avx.hpp>
+#include <random_fill.hpp>
+
+// Rows processed together by softmax_batched
+#ifndef BATCH_ROWS
+#define BATCH_ROWS 4
+#endif
+
+// Softmax of R consecutive rows, pass by pass: in every pass the R rows
+// have independent dependency chains (max, exp256_ps and sum), so their
+// latencies overlap instead of running one row after the other.
+// Kbody, mask and mask_ps depend only on K and are computed by the caller.
+template <size_t R>
+inline void softmax_rows_avx(const float *input, float *output, size_t K, size_t ld,
+							 size_t Kbody, __m256i mask, __m256 mask_ps) {
+	const __m256 lowest = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	__m256 max_val[R], tail_val[R], max_vec[R], sum_vec[R], exp_tail[R], sum_vect[R];
+
+	// Find the maximum to stabilize the computation of the exponential
+	#pragma GCC unroll 4
+	for (size_t r = 0; r < R; ++r) {
+		max_val[r] = lowest;
+	}
+	for (size_t i = 0; i < Kbody; i += 8) {
+		#pragma GCC unroll 4
+		for (size_t r = 0; r < R; ++r) {
+			max_val[r] = _mm256_max_ps(max_val[r], _mm256_loadu_ps(input + r * ld + i));
+		}
+	}
+	#pragma GCC unroll 4
+	for (size_t r = 0; r < R; ++r) {
+		// The masked-out lanes are loaded as 0, replace them with lowest
+		tail_val[r] = _mm256_blendv_ps(lowest, _mm256_maskload_ps(input + r * ld + Kbody, mask), mask_ps);
+		max_vec[r] = _mm256_set1_ps(hmax_avx(_mm256_max_ps(max_val[r], tail_val[r])));
+		sum_vec[r] = _mm256_setzero_ps();
+	}
+
+	// Computes all exponentials with the shift of max_val and the total sum
+	for (size_t i = 0; i < Kbody; i += 8) {
+		#pragma GCC unroll 4
+		for (size_t r = 0; r < R; ++r) {
+			__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(input + r * ld + i), max_vec[r]));
+			_mm256_storeu_ps(output + r * ld + i, exp_val);
+			sum_vec[r] = _mm256_add_ps(sum_vec[r], exp_val);
+		}
+	}
+	#pragma GCC unroll 4
+	for (size_t r = 0; r < R; ++r) {
+		exp_tail[r] = _mm256_and_ps(exp256_ps(_mm256_sub_ps(tail_val[r], max_vec[r])), mask_ps);
+		_mm256_maskstore_ps(output + r * ld + Kbody, mask, exp_tail[r]);
+		sum_vect[r] = norm_factor_avx<default_normalize>(hsum_avx(_mm256_add_ps(sum_vec[r], exp_tail[r])));
+	}
+
+	// Normalize by the total sum
+	for (size_t i = 0; i < Kbody; i += 8) {
+		#pragma GCC unroll 4
+		for (size_t r = 0; r < R; ++r) {
+			float *out = output + r * ld + i;
+			_mm256_storeu_ps(out, normalize_avx<default_normalize>(_mm256_loadu_ps(out), sum_vect[r]));
+		}
+	}
+	#pragma GCC unroll 4
+	for (size_t r = 0; r < R; ++r) {
+		_mm256_maskstore_ps(output + r * ld + Kbody, mask, normalize_avx<default_normalize>(exp_tail[r], sum_vect[r]));
+	}
+}
+
+// Row-wise softmax of a [rows x K] matrix stored with leading dimension ld
+// (distance, in floats, between the beginning of two consecutive rows).
+// The same ld is used for input and output, and it must be >= K.
+// Everything that depends only on K (loop bound, tail mask) is computed once
+// for all the rows, and the tail is always handled with masks, so K < 8 is
+// also supported. The rows are split in contiguous blocks among num_threads
+// threads, and every thread processes BATCH_ROWS rows at a time.
+void softmax_batched(const float *input, float *output, size_t rows, size_t K, size_t ld, int num_threads = 1) {
+
+	// Setup shared by all the rows
+	const size_t Kbody = K - (K % 8);
+	const __m256i mask = tail_mask_avx(K % 8);
+	const __m256 mask_ps = _mm256_castsi256_ps(mask);
+
+	auto block = [&](size_t begin, size_t end) {
+		size_t r = begin;
+		for (; r + BATCH_ROWS <= end; r += BATCH_ROWS) {
+			softmax_rows_avx<BATCH_ROWS>(input + r * ld, output + r * ld, K, ld, Kbody, mask, mask_ps);
+		}
+		for (; r < end; ++r) {
+			softmax_rows_avx<1>(input + r * ld, output + r * ld, K, ld, Kbody, mask, mask_ps);
+		}
+	};
+
+	num_threads = (int)std::max<size_t>(1, std::min<size_t>(num_threads, SDIV(rows, BATCH_ROWS)));
+	size_t rows_per_thread = SDIV(SDIV(rows, BATCH_ROWS), (size_t)num_threads) * BATCH_ROWS;
+	std::vector<std::thread> threads;
+	for (int t = 1; t < num_threads; ++t) {
+		threads.emplace_back(block, std::min(rows, t * rows_per_thread), std::min(rows, (t + 1) * rows_per_thread));
+	}
+	block(0, std::min(rows, rows_per_thread));
+	for (auto &t : threads) {
+		t.join();
+	}
+}
+
+// Median time in seconds of reps calls of f, after one call to warm up the
+// caches and fault in the pages
+template <typename F>
+double median_time(F f, int reps = 11) {
+	f();
+	std::vector<double> times;
+	for (int i = 0; i < reps; ++i) {
+		auto a = std::chrono::steady_clock::now();
+		f();
+		auto b = std::chrono::steady_clock::now();
+		times.push_back(std::chrono::duration<double>(b - a).count());
+	}
+	std::nth_element(times.begin(), times.begin() + reps / 2, times.end());
+	return times[reps / 2];
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printResult(aligned_vector<float> &v, size_t rows, size_t K, size_t ld) {
+	for (size_t r = 0; r < rows; ++r) {
+		for (size_t i = 0; i < K; ++i) {
+			std::fprintf(stderr, "%f\n", v[r * ld + i]);
+		}
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		std::printf("use: %s rows K [threads] [1]\n", argv[0]);
+		return 0;
+	}
+	size_t rows = std::stol(argv[1]);
+	size_t K = std::stol(argv[2]);
+	int num_threads = (argc >= 4) ? std::stoi(argv[3]) : 1;
+	bool print=false;
+	if (argc == 5) {
+		print=true;
+	}
+	if (num_threads < 1) {
+		std::cerr << "Error: the number of threads must be positive" << std::endl;
+		return 1;
+	}
+	// Rows are padded to a multiple of 8 floats to exercise the stride
+	size_t ld = SDIV(K, 8) * 8;
+
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(rows * ld);
+	aligned_vector<float> output(rows * ld);
+	aligned_vector<float> output_loop(rows * ld);
+
+	double time_batched = median_time([&] {
+		softmax_batched(input.data(), output.data(), rows, K, ld, num_threads);
+	});
+	double time_loop = median_time([&] {
+		for (size_t r = 0; r < rows; ++r) {
+			softmax_avx(input.data() + r * ld, output_loop.data() + r * ld, K);
+		}
+	});
+	std::cout << "# elapsed time (softime_batched): " << time_batched << "s" << std::endl;
+	std::cout << "# elapsed time (softime_avx_loop): " << time_loop << "s" << std::endl;
+	std::cout << "# speedup (softime_avx_loop/softime_batched): " << time_loop / time_batched << std::endl;
+
+	float max_diff = 0.0f;
+	for (size_t r = 0; r < rows; ++r) {
+		for (size_t i = 0; i < K; ++i) {
+			max_diff = std::max(max_diff, std::fabs(output[r * ld + i] - output_loop[r * ld + i]));
+		}
+	}
+	std::cout << "# max abs difference (batched vs avx loop): " << max_diff << std::endl;
+
+	// print the results on the standard output
+	if (print) {
+		printResult(output, rows, K, ld);
+	}
+}
@@ -0,0 +1,267 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unistd.h> //getopt, sysconf
+#include <x86intrin.h> //__rdtsc
+#include <aligned_allocator.hpp>
+#include <softmax_kernels.hpp>
+#include <random_fill.hpp>
+
+// Micro-benchmark of the kernels of libsoftmax.a (by default plain, auto
+// and avx; the threaded kernels run with one thread).
+// For every kernel and size: warmup, then samples of enough calls to last at
+// least MIN_SAMPLE_TIME, repeated until the 95% confidence interval of the
+// mean is within the requested fraction of the mean (or until the maximum
+// number of samples or time). Reports median, p99 and minimum time per call,
+// cycles per element and GB/s, as a table, CSV or JSON.
+// Cycles are TSC cycles (constant frequency), not core cycles.
+
+static const double MIN_SAMPLE_TIME = 50e-6;
+
+struct Options {
+	std::vector<std::string> kernels{"plain", "auto", "avx"};
+	std::vector<size_t> sizes;            // empty: one size per cache level + DRAM
+	std::string format = "table";         // table, csv or json
+	double warmup = 0.1;                  // seconds
+	size_t min_reps = 10;
+	size_t max_reps = 1000;
+	double max_time = 2.0;                // seconds per kernel and size
+	double rel_ci = 0.01;                 // target half-width of the CI / mean
+};
+
+struct Result {
+	std::string kernel;
+	size_t K;
+	std::string level;
+	size_t samples, calls_per_sample;
+	double median, p99, min, mean, stddev; // seconds per call
+	double cycles_per_elem, gbs;
+};
+
+// Cache sizes from sysconf, with common defaults if unknown
+static size_t cache_size(int name, size_t fallback) {
+	long size = sysconf(name);
+	return size > 0 ? size : fallback;
+}
+
+static size_t l1_size() { return cache_size(_SC_LEVEL1_DCACHE_SIZE, 32 << 10); }
+static size_t l2_size() { return cache_size(_SC_LEVEL2_CACHE_SIZE, 1 << 20); }
+static size_t l3_size() { return cache_size(_SC_LEVEL3_CACHE_SIZE, 32 << 20); }
+
+// Smallest level holding input and output
+static const char *residency(size_t K) {
+	size_t bytes = 2 * K * sizeof(float);
+	if (bytes <= l1_size()) return "L1";
+	if (bytes <= l2_size()) return "L2";
+	if (bytes <= l3_size()) return "L3";
+	return "DRAM";
+}
+
+// Input and output filling half of each cache level, plus twice the LLC
+static std::vector<size_t> default_sizes() {
+	const size_t bytes_per_K = 2 * sizeof(float);
+	return {l1_size() / 2 / bytes_per_K, l2_size() / 2 / bytes_per_K,
+			l3_size() / 2 / bytes_per_K, 2 * l3_size() / bytes_per_K};
+}
+
+template <typename Vector>
+static void fill_random(Vector &v, float min = -1.0f, float max = 1.0f) {
+	random_fill_uniform(v.data(), v.size(), 5489, min, max); // fixed seed for reproducible results
+}
+
+static Result run(const SoftmaxKernel &kernel, size_t K, const Options &opt) {
+	using clock = std::chrono::steady_clock;
+	aligned_vector<float> input(K), output(K);
+	fill_random(input);
+
+	// Warmup, also estimates the time of one call
+	size_t calls = 0;
+	auto start = clock::now();
+	std::chrono::duration<double> elapsed{0};
+	do {
+		kernel.fn(input.data(), output.data(), K, 1);
+		++calls;
+		elapsed = clock::now() - start;
+	} while (elapsed.count() < opt.warmup);
+	double per_call = elapsed.count() / calls;
+	size_t inner = std::max<size_t>(1, std::ceil(MIN_SAMPLE_TIME / per_call));
+
+	std::vector<double> times, cycles;
+	double sum = 0.0, sum2 = 0.0, total = 0.0;
+	while (times.size() < opt.max_reps && total < opt.max_time) {
+		auto t0 = clock::now();
+		unsigned long long c0 = __rdtsc();
+		for (size_t i = 0; i < inner; ++i) {
+			kernel.fn(input.data(), output.data(), K, 1);
+		}
+		unsigned long long c1 = __rdtsc();
+		std::chrono::duration<double> dt = clock::now() - t0;
+		total += dt.count();
+
+		double t = dt.count() / inner;
+		times.push_back(t);
+		cycles.push_back(double(c1 - c0) / inner);
+		sum += t;
+		sum2 += t * t;
+
+		size_t n = times.size();
+		if (n >= opt.min_reps) {
+			double mean = sum / n;
+			double stddev = std::sqrt(std::max(0.0, sum2 / n - mean * mean));
+			if (1.96 * stddev / std::sqrt(double(n)) <= opt.rel_ci * mean) {
+				break;
+			}
+		}
+	}
+
+	Result r;
+	r.kernel = kernel.name;
+	r.K = K;
+	r.level = residency(K);
+	r.samples = times.size();
+	r.calls_per_sample = inner;
+	r.mean = sum / r.samples;
+	r.stddev = std::sqrt(std::max(0.0, sum2 / r.samples - r.mean * r.mean));
+	std::sort(times.begin(), times.end());
+	std::sort(cycles.begin(), cycles.end());
+	r.median = times[r.samples / 2];
+	r.p99 = times[std::min(r.samples - 1, size_t(std::ceil(0.99 * r.samples)) - 1)];
+	r.min = times[0];
+	r.cycles_per_elem = cycles[r.samples / 2] / K;
+	r.gbs = kernel.traffic(K) * K * sizeof(float) / r.median / 1e9;
+	return r;
+}
+
+static void print_header(const std::string &format) {
+	if (format == "csv") {
+		std::printf("kernel,K,level,samples,calls_per_sample,median_s,p99_s,min_s,mean_s,stddev_s,cycles_per_elem,GBs\n");
+	} else if (format == "table") {
+		std::printf("%-13s %12s %5s %8s %14s %14s %14s %10s %8s\n",
+					"kernel", "K", "level", "samples", "median(s)", "p99(s)", "min(s)", "cyc/elem", "GB/s");
+	}
+}
+
+static void print_result(const Result &r, const std::string &format, bool first) {
+	if (format == "csv") {
+		std::printf("%s,%zu,%s,%zu,%zu,%.6e,%.6e,%.6e,%.6e,%.6e,%.4f,%.4f\n",
+					r.kernel.c_str(), r.K, r.level.c_str(), r.samples, r.calls_per_sample,
+					r.median, r.p99, r.min, r.mean, r.stddev, r.cycles_per_elem, r.gbs);
+	} else if (format == "json") {
+		std::printf("%s\n  {\"kernel\": \"%s\", \"K\": %zu, \"level\": \"%s\", \"samples\": %zu, "
+					"\"calls_per_sample\": %zu, \"median_s\": %.6e, \"p99_s\": %.6e, \"min_s\": %.6e, "
+					"\"mean_s\": %.6e, \"stddev_s\": %.6e, \"cycles_per_elem\": %.4f, \"GBs\": %.4f}",
+					first ? "" : ",", r.kernel.c_str(), r.K, r.level.c_str(), r.samples, r.calls_per_sample,
+					r.median, r.p99, r.min, r.mean, r.stddev, r.cycles_per_elem, r.gbs);
+	} else {
+		std::printf("%-13s %12zu %5s %8zu %14.6e %14.6e %14.6e %10.3f %8.2f\n",
+					r.kernel.c_str(), r.K, r.level.c_str(), r.samples,
+					r.median, r.p99, r.min, r.cycles_per_elem, r.gbs);
+	}
+	std::fflush(stdout);
+}
+
+static std::vector<std::string> split(const std::string &s) {
+	std::vector<std::string> items;
+	size_t start = 0, end;
+	while ((end = s.find(',', start)) != std::string::npos) {
+		items.push_back(s.substr(start, end - start));
+		start = end + 1;
+	}
+	items.push_back(s.substr(start));
+	return items;
+}
+
+static void usage(const char *argv0) {
+	Options opt;
+	std::printf("--------------------------\n");
+	std::printf("Usage: %s [options]\n", argv0);
+	std::printf("\nOptions:\n");
+	std::printf(" -k list: kernels of libsoftmax.a, comma separated (defaults to plain,auto,avx).\n");
+	std::printf(" -s list: values of K, comma separated (defaults to one per cache level and one in DRAM).\n");
+	std::printf(" -f F: output format, table, csv or json (defaults to %s).\n", opt.format.c_str());
+	std::printf(" -w S: warmup seconds (defaults to %g).\n", opt.warmup);
+	std::printf(" -r R: maximum number of samples (defaults to %zu).\n", opt.max_reps);
+	std::printf(" -t S: maximum seconds per kernel and K (defaults to %g).\n", opt.max_time);
+	std::printf(" -e E: target relative half-width of the 95%% CI (defaults to %g).\n", opt.rel_ci);
+	std::printf("--------------------------\n");
+}
+
+static int parseCommandLine(int argc, char *argv[], Options &opt) {
+	int c;
+	while ((c = getopt(argc, argv, "k:s:f:w:r:t:e:h")) != -1) {
+		try {
+			switch (c) {
+				case 'k': opt.kernels = split(optarg); break;
+				case 's':
+					opt.sizes.clear();
+					for (const auto &s : split(optarg)) {
+						opt.sizes.push_back(std::stoul(s));
+					}
+					break;
+				case 'f': opt.format = optarg; break;
+				case 'w': opt.warmup = std::stod(optarg); break;
+				case 'r': opt.max_reps = std::stoul(optarg); break;
+				case 't': opt.max_time = std::stod(optarg); break;
+				case 'e': opt.rel_ci = std::stod(optarg); break;
+				default:
+					usage(argv[0]);
+					return -1;
+			}
+		} catch (const std::exception &) {
+			std::fprintf(stderr, "Error: wrong '-%c' option\n", c);
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (opt.format != "table" && opt.format != "csv" && opt.format != "json") {
+		std::fprintf(stderr, "Error: unknown format %s\n", opt.format.c_str());
+		return -1;
+	}
+	if (opt.max_reps < 1 || std::count(opt.sizes.begin(), opt.sizes.end(), 0)) {
+		std::fprintf(stderr, "Error: sizes and number of samples must be positive\n");
+		return -1;
+	}
+	return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+	Options opt;
+	if (parseCommandLine(argc, argv, opt) < 0) {
+		return 1;
+	}
+	if (opt.sizes.empty()) {
+		opt.sizes = default_sizes();
+	}
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+
+	std::vector<const SoftmaxKernel *> selected;
+	for (const auto &name : opt.kernels) {
+		const SoftmaxKernel *kernel = find_softmax_kernel(name);
+		if (!kernel || !kernel->supported) {
+			std::fprintf(stderr, "Error: kernel %s unknown or not supported\n", name.c_str());
+			return 1;
+		}
+		selected.push_back(kernel);
+	}
+
+	if (opt.format == "json") {
+		std::printf("[");
+	}
+	print_header(opt.format);
+	bool first = true;
+	for (size_t K : opt.sizes) {
+		for (const SoftmaxKernel *kernel : selected) {
+			print_result(run(*kernel, K, opt), opt.format, first);
+			first = false;
+		}
+	}
+	if (opt.format == "json") {
+		std::printf("\n]\n");
+	}
+}
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <string>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <aligned_allocator.hpp>
+#include <softmax_kernels.hpp>
+#include <random_fill.hpp>
+
+// Accuracy regression check of all the kernels of libsoftmax.a against a
+// double-precision softmax, on random and adversarial inputs (large
+// magnitudes, all equal, one-hot, -inf entries, K < 8 and K not multiple
+// of 8). For every kernel and input it checks the max relative error of
+// the outputs and the distance of their sum from one; it prints the
+// failures (every check with -v) and exits with 1 if there are any.
+// The streaming path of softmax_stream_avx, which stream uses only above the
+// LLC size, is checked on every input through the stream_nt kernel.
+// The sizes not multiple of 16 are also run with input and output starting
+// 4 bytes after an aligned address, and ending right before a PROT_NONE
+// page, so that an unaligned load or a read or write past the end of a
+// tail crashes the check.
+// It also checks that random_fill_uniform, which generates the inputs of
+// the drivers, gives the same values with any number of threads.
+
+struct Case {
+	std::string name;
+	std::function<float(size_t, std::mt19937 &)> value; // value of position i
+};
+
+void softmax_ref(const float *input, double *output, size_t K) {
+	double max_val = -std::numeric_limits<double>::infinity();
+	for (size_t i = 0; i < K; ++i) {
+		max_val = std::max(max_val, (double)input[i]);
+	}
+	double sum = 0.0;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] = std::exp(input[i] - max_val);
+		sum += output[i];
+	}
+	for (size_t i = 0; i < K; ++i) {
+		output[i] /= sum;
+	}
+}
+
+// K floats whose last one ends at the beginning of an inaccessible page
+struct GuardedBuffer {
+	explicit GuardedBuffer(size_t K) {
+		const size_t page = sysconf(_SC_PAGESIZE);
+		bytes = (K * sizeof(float) + page - 1) / page * page + page;
+		base = (char *)mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (base == MAP_FAILED) {
+			throw std::bad_alloc();
+		}
+		mprotect(base + bytes - page, page, PROT_NONE);
+		data = (float *)(base + bytes - page) - K;
+	}
+	~GuardedBuffer() { munmap(base, bytes); }
+	GuardedBuffer(const GuardedBuffer &) = delete;
+	GuardedBuffer &operator=(const GuardedBuffer &) = delete;
+
+	char *base;
+	size_t bytes;
+	float *data;
+};
+
+// The error of a float sum of K terms grows linearly with K (up to K * eps
+// in the worst case). K * eps / 64 is about 30 times the error of the plain
+// kernel (one float accumulator) at K = 10^6, and still far below the error
+// of a wrong mask or a lost tail
+double tolerance(size_t K) {
+	return 1e-5 + K * std::numeric_limits<float>::epsilon() / 64;
+}
+
+
+int main(int argc, char *argv[]) {
+	bool verbose = (argc >= 2 && std::string(argv[1]) == "-v");
+	const float neg_inf = -std::numeric_limits<float>::infinity();
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	const std::vector<Case> cases = {
+		{"random", [&](size_t, std::mt19937 &g) { return unit(g); }},
+		{"wide", [&](size_t, std::mt19937 &g) { return 80.0f * unit(g); }},
+		{"large", [&](size_t, std::mt19937 &g) { return 1e30f * unit(g); }},
+		{"offset", [&](size_t, std::mt19937 &g) { return 1e4f + unit(g); }},
+		{"equal", [&](size_t, std::mt19937 &) { return 5.0f; }},
+		{"onehot", [&](size_t i, std::mt19937 &) { return i == 3 ? 50.0f : 0.0f; }},
+		{"neg_inf", [&](size_t i, std::mt19937 &g) { float x = unit(g); return (i % 5 == 1) ? neg_inf : x; }},
+		{"lowest", [&](size_t i, std::mt19937 &) { return i == 0 ? 0.0f : std::numeric_limits<float>::lowest(); }}
+	};
+	const std::vector<size_t> sizes = {1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 33, 100, 127, 128, 129, 1000, 4099, 65536, 1000003};
+
+	size_t checks = 0, failures = 0;
+	for (const auto &c : cases) {
+		for (size_t K : sizes) {
+			aligned_vector<float> input(K), output(K);
+			std::vector<double> ref(K);
+			std::mt19937 gen(5489); // fixed seed for reproducible results
+			for (size_t i = 0; i < K; ++i) {
+				input[i] = c.value(i, gen);
+			}
+			softmax_ref(input.data(), ref.data(), K);
+
+			// Aligned buffers, plus unaligned and guarded copies for the
+			// sizes with a tail
+			aligned_vector<float> input_off(K + 1), output_off(K + 1);
+			GuardedBuffer input_guard(K), output_guard(K);
+			std::copy(input.begin(), input.end(), input_off.begin() + 1);
+			std::copy(input.begin(), input.end(), input_guard.data);
+			struct Layout {
+				const char *name;
+				const float *in;
+				float *out;
+			};
+			std::vector<Layout> layouts = {{"aligned", input.data(), output.data()}};
+			if (K % 16 != 0) {
+				layouts.push_back({"offset", input_off.data() + 1, output_off.data() + 1});
+				layouts.push_back({"guard", input_guard.data, output_guard.data});
+			}
+
+			for (const auto &kernel : softmax_kernels()) {
+				if (!kernel.supported) {
+					continue;
+				}
+				for (const auto &layout : layouts) {
+					float *out = layout.out;
+					std::fill(out, out + K, std::numeric_limits<float>::quiet_NaN());
+					kernel.fn(layout.in, out, K, 3);
+
+					// Relative error, absolute below 1e-30 (exp256_ps gives
+					// about 1e-38 instead of 0 for -inf inputs)
+					double max_rel = 0.0, sum = 0.0;
+					for (size_t i = 0; i < K; ++i) {
+						double err = std::abs(out[i] - ref[i]) / std::max(ref[i], 1e-30);
+						max_rel = std::isnan(err) ? std::numeric_limits<double>::infinity() : std::max(max_rel, err);
+						sum += out[i];
+					}
+					double sum_err = std::isnan(sum) ? std::numeric_limits<double>::infinity() : std::abs(sum - 1.0);
+					bool ok = max_rel <= tolerance(K) && sum_err <= tolerance(K);
+
+					++checks;
+					failures += !ok;
+					if (!ok || verbose) {
+						std::printf("%-4s %-14s %-8s %-7s K=%-8zu max_rel=%.3e sum_err=%.3e tol=%.1e\n",
+									ok ? "ok" : "FAIL", kernel.name, c.name.c_str(), layout.name, K, max_rel,
+									sum_err, tolerance(K));
+					}
+				}
+			}
+		}
+	}
+	// The parallel fill must cover the whole buffer for ragged n, and write
+	// the same values as one thread
+	for (size_t n : {33ul, 131073ul, 196609ul, 1000003ul, 10000001ul}) {
+		aligned_vector<float> ref_fill(n);
+		random_fill_uniform(ref_fill.data(), n, 5489, -1.0f, 1.0f, 0, 1);
+		for (int threads : {2, 3, 4, 7}) {
+			aligned_vector<float> fill(n, std::numeric_limits<float>::quiet_NaN());
+			random_fill_uniform(fill.data(), n, 5489, -1.0f, 1.0f, 0, threads);
+			bool ok = std::equal(fill.begin(), fill.end(), ref_fill.begin());
+			++checks;
+			failures += !ok;
+			if (!ok || verbose) {
+				std::printf("%-4s %-14s n=%-8zu threads=%d\n", ok ? "ok" : "FAIL", "random_fill", n, threads);
+			}
+		}
+	}
+
+	std::printf("# %zu checks, %zu failures\n", checks, failures);
+	return failures ? 1 : 0;
+}
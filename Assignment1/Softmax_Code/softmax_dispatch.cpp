@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <string>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <softmax_dispatch.hpp>
+#include <random_fill.hpp>
+
+// This file is compiled for the generic x86-64 target, so that the binary
+// runs on every node: the AVX2 and AVX-512 kernels live in separate
+// translation units and are selected at run time.
+
+void softmax_scalar(const float *input, float *output, size_t K) {
+	// Find the maximum to stabilize the computation of the exponential
+	float max_val = -std::numeric_limits<float>::infinity();
+	for (size_t i = 0; i < K; ++i) {
+		max_val = std::max(max_val, input[i]);
+	}
+
+	// computes all exponentials with the shift of max_val and the total sum
+	float sum = 0.0f;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] = std::exp(input[i] - max_val);
+		sum += output[i];
+	}
+
+	// normalize by multiplying for the reciprocal of the total sum
+	const float inv_sum = 1.0f / sum;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] *= inv_sum;
+	}
+}
+
+using softmax_fn = void (*)(const float *, float *, size_t);
+
+struct SoftmaxImpl {
+	const char *name;
+	softmax_fn fn;
+	bool supported;
+};
+
+// Kernels from the widest to the narrowest ISA, checked with cpuid
+// (__builtin_cpu_supports also verifies that the OS saves the registers)
+std::vector<SoftmaxImpl> softmax_impls() {
+	__builtin_cpu_init();
+	return {
+		{"avx512", softmax_dispatch_avx512, (bool)__builtin_cpu_supports("avx512f")},
+		{"avx2", softmax_dispatch_avx2,
+		 __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")},
+		{"scalar", softmax_scalar, true}
+	};
+}
+
+// Returns the widest supported kernel, or the one called name if requested.
+// Returns nullptr if the requested kernel is unknown or not supported.
+const SoftmaxImpl *select_softmax(const std::vector<SoftmaxImpl> &impls, const std::string &name = "") {
+	for (const auto &impl : impls) {
+		if (name.empty() ? impl.supported : name == impl.name) {
+			return impl.supported ? &impl : nullptr;
+		}
+	}
+	return nullptr;
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printResult(aligned_vector<float> &v, size_t K) {
+	for(size_t i=0; i<K; ++i) {
+		std::fprintf(stderr, "%f\n",v[i]);
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [avx512|avx2|scalar] [1]\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	std::string name = (argc >= 3) ? argv[2] : "";
+	bool print=false;
+	if (argc == 4) {
+		print=true;
+	}
+
+	std::vector<SoftmaxImpl> impls = softmax_impls();
+	const SoftmaxImpl *impl = select_softmax(impls, name);
+	if (!impl) {
+		std::cerr << "Error: kernel '" << name << "' unknown or not supported by this CPU" << std::endl;
+		return 1;
+	}
+	std::cout << "Selected kernel: " << impl->name << std::endl;
+
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(K);
+	aligned_vector<float> output(K);
+
+	TIMERSTART(softime_dispatch);
+	impl->fn(input.data(), output.data(), K);
+	TIMERSTOP(softime_dispatch);
+
+	// print the results on the standard output
+	if (print) {
+		printResult(output, K);
+	}
+}
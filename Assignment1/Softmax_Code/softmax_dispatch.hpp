@@ -0,0 +1,15 @@
+#ifndef SOFTMAX_DISPATCH_HPP
+#define SOFTMAX_DISPATCH_HPP
+
+#include <cstddef>
+
+// Kernels compiled in their own translation unit with the flags of a single
+// ISA (dispatch_avx2.cpp, dispatch_avx512.cpp). They must be called only
+// after checking at run time that the CPU supports that ISA.
+// Those translation units must not share inline functions or templates with
+// the rest of the program: the linker could keep the copy compiled for the
+// wider ISA and use it also on the generic path.
+void softmax_dispatch_avx2(const float *input, float *output, size_t K);
+void softmax_dispatch_avx512(const float *input, float *output, size_t K);
+
+#endif // SOFTMAX_DISPATCH_HPP
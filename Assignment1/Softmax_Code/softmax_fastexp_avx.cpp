@@ -0,0 +1,127 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <hpc_helpers.hpp>
+#include <fastexp_avx.hpp>
+#include <random_fill.hpp>
+
+// Validation tool for the polynomial exponential: runs the softmax with the
+// Cephes exp256_ps and with exp256_neg_ps at every accuracy level, and
+// compares the outputs with the scalar softmax_plain (std::exp).
+// The reference accumulates the sum in double: with a float accumulator its
+// own rounding error grows with K and would hide the one of the exponential.
+
+void softmax_plain(const float *input, float *output, size_t K) {
+	// Find the maximum to stabilize the computation of the exponential
+	float max_val = -std::numeric_limits<float>::infinity();
+	for (size_t i = 0; i < K; ++i) {
+		max_val = std::max(max_val, input[i]);
+	}
+
+	// computes all exponentials with the shift of max_val and the total sum
+	double sum = 0.0;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] = std::exp(input[i] - max_val);
+		sum += output[i];
+	}
+
+	// normalize by dividing for the total sum
+	for (size_t i = 0; i < K; ++i) {
+		output[i] = output[i] / sum;
+	}
+}
+
+// Distance in units in the last place between two non-negative floats
+uint32_t ulp_distance(float a, float b) {
+	uint32_t ia, ib;
+	std::memcpy(&ia, &a, sizeof(float));
+	std::memcpy(&ib, &b, sizeof(float));
+	return (ia > ib) ? ia - ib : ib - ia;
+}
+
+struct Error {
+	uint32_t max_ulp = 0;
+	double max_rel = 0.0;
+};
+
+Error compare(const std::vector<float> &v, const std::vector<float> &ref) {
+	Error err;
+	for (size_t i = 0; i < v.size(); ++i) {
+		err.max_ulp = std::max(err.max_ulp, ulp_distance(v[i], ref[i]));
+		if (ref[i] != 0.0f) {
+			err.max_rel = std::max(err.max_rel, std::abs(((double)v[i] - ref[i]) / ref[i]));
+		}
+	}
+	return err;
+}
+
+void printError(const char *label, const Error &err) {
+	std::cout << "# " << label << ": max ulp = " << err.max_ulp
+			  << ", max rel error = " << err.max_rel << std::endl;
+}
+
+// Error of the exponential alone on a uniform grid of [-87, 0]
+template <ExpAccuracy A>
+Error exp_error(size_t n) {
+	std::vector<float> x(n), v(n), ref(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = -87.0f * i / (n - 1);
+		ref[i] = std::exp(x[i]);
+	}
+	for (size_t i = 0; i + 8 <= n; i += 8) {
+		_mm256_storeu_ps(v.data() + i, exp256_neg_ps<A>(_mm256_loadu_ps(x.data() + i)));
+	}
+	v.resize(n - n % 8);
+	ref.resize(n - n % 8);
+	return compare(v, ref);
+}
+
+std::vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	std::vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	std::vector<float> input=generate_random_input(K);
+	std::vector<float> ref(K), output(K);
+
+	TIMERSTART(softime_plain);
+	softmax_plain(input.data(), ref.data(), K);
+	TIMERSTOP(softime_plain);
+
+	TIMERSTART(softime_avx);
+	softmax_avx(input.data(), output.data(), K);
+	TIMERSTOP(softime_avx);
+	printError("softmax error (cephes)", compare(output, ref));
+
+	TIMERSTART(softime_fastexp_fast);
+	softmax_fastexp_avx<ExpAccuracy::fast>(input.data(), output.data(), K);
+	TIMERSTOP(softime_fastexp_fast);
+	printError("softmax error (fast)", compare(output, ref));
+
+	TIMERSTART(softime_fastexp_medium);
+	softmax_fastexp_avx<ExpAccuracy::medium>(input.data(), output.data(), K);
+	TIMERSTOP(softime_fastexp_medium);
+	printError("softmax error (medium)", compare(output, ref));
+
+	TIMERSTART(softime_fastexp_accurate);
+	softmax_fastexp_avx<ExpAccuracy::accurate>(input.data(), output.data(), K);
+	TIMERSTOP(softime_fastexp_accurate);
+	printError("softmax error (accurate)", compare(output, ref));
+
+	const size_t n = 1 << 20;
+	printError("exp error on [-87, 0] (fast)", exp_error<ExpAccuracy::fast>(n));
+	printError("exp error on [-87, 0] (medium)", exp_error<ExpAccuracy::medium>(n));
+	printError("exp error on [-87, 0] (accurate)", exp_error<ExpAccuracy::accurate>(n));
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <sys/stat.h>
+#include <hpc_helpers.hpp>
+#include <chunked_avx.hpp>
+#include <random_fill.hpp>
+
+// Streaming softmax over a file of raw float32 logits, with memory bounded by
+// the chunk size (see chunked_avx.hpp). The gen mode writes a file of K
+// random logits, chunk by chunk, with the same values generate_random_input
+// would give.
+
+void generate_random_file(const std::string &path, size_t K, size_t chunk, float min = -1.0f, float max = 1.0f) {
+	ChunkWriter writer(path, chunk);
+	for (size_t done = 0; done < K;) {
+		size_t n = std::min(chunk, K - done);
+		// Elements [done, done + n) of the stream, fixed seed for reproducible results
+		random_fill_uniform(writer.buffer(), n, 5489, min, max, done);
+		writer.submit(n);
+		done += n;
+	}
+	if (!writer.finish()) {
+		throw std::runtime_error("error writing " + path);
+	}
+}
+
+// Sum of the output file, in double, read again chunk by chunk
+double file_sum(const std::string &path, size_t chunk) {
+	ChunkReader reader(path, chunk);
+	double sum = 0.0;
+	size_t n;
+	while (const float *in = reader.next(n)) {
+		for (size_t i = 0; i < n; ++i) {
+			sum += in[i];
+		}
+	}
+	return sum;
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		std::printf("use: %s gen FILE K\n", argv[0]);
+		std::printf("     %s INPUT OUTPUT [chunk_MB] [1]\n", argv[0]);
+		return 0;
+	}
+	try {
+		if (std::string(argv[1]) == "gen") {
+			if (argc < 4) {
+				std::cerr << "Error: missing K" << std::endl;
+				return 1;
+			}
+			generate_random_file(argv[2], std::stoul(argv[3]), 1 << 22);
+			return 0;
+		}
+
+		std::string input = argv[1], output = argv[2];
+		size_t chunk_mb = (argc >= 4) ? std::stoul(argv[3]) : 16;
+		if (chunk_mb == 0) {
+			std::cerr << "Error: chunk_MB must be positive" << std::endl;
+			return 1;
+		}
+		size_t chunk = (chunk_mb << 20) / sizeof(float);
+		bool check = (argc == 5);
+		struct stat st;
+		if (stat(input.c_str(), &st) != 0) {
+			std::cerr << "Error: cannot open " << input << std::endl;
+			return 1;
+		}
+
+		TIMERSTART(softime_file);
+		SoftmaxStats stats = softmax_file_avx(input, output, chunk);
+		TIMERSTOP(softime_file);
+
+		// the input is read twice and the output written once
+		std::cout << "# K: " << st.st_size / sizeof(float) << ", max: " << stats.max << ", sum: " << stats.sum << std::endl;
+		std::cout << "# bandwidth (3 x file size): " << 3.0 * st.st_size / deltasoftime_file.count() / 1e9 << " GB/s" << std::endl;
+		std::cout << "# buffers: 4 x " << chunk_mb << " MB" << std::endl;
+		if (check) {
+			std::cout << "# output sum: " << file_sum(output, chunk) << std::endl;
+		}
+	} catch (const std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <half_avx.hpp>
+#include <random_fill.hpp>
+
+// Throughput of softmax on fp16 and bf16 inputs, with fp32 or 16-bit output,
+// against softmax_avx on fp32 data. The bandwidth is computed on the bytes of
+// input and output (what the caller has to move), the error against
+// softmax_avx on the same values widened to fp32. Best time over reps calls.
+
+template <typename F>
+double best_time(F &&fn, int reps) {
+	double best = std::numeric_limits<double>::max();
+	for (int r = 0; r < reps; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+// Scalar conversions, only used to prepare the inputs and check the results
+uint16_t float_to_half(float x, HalfFormat f) {
+	if (f == HalfFormat::fp16) {
+		return _cvtss_sh(x, _MM_FROUND_TO_NEAREST_INT);
+	}
+	uint32_t bits;
+	std::memcpy(&bits, &x, sizeof(bits));
+	bits += 0x7fff + ((bits >> 16) & 1);
+	return bits >> 16;
+}
+
+float half_to_float(uint16_t h, HalfFormat f) {
+	if (f == HalfFormat::fp16) {
+		return _cvtsh_ss(h);
+	}
+	uint32_t bits = uint32_t(h) << 16;
+	float x;
+	std::memcpy(&x, &bits, sizeof(x));
+	return x;
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printRow(const char *label, double seconds, size_t bytes_per_elem, size_t K, float err) {
+	std::printf("%-12s %14.6e %10.2f %14.6e\n", label, seconds, double(bytes_per_elem) * K / seconds / 1e9, err);
+}
+
+template <HalfFormat F>
+void run(const char *name_f32, const char *name_half, const aligned_vector<float> &values, size_t K, int reps) {
+	aligned_vector<uint16_t> input(K), output_half(K);
+	aligned_vector<float> widened(K), ref(K), output(K);
+	for (size_t i = 0; i < K; ++i) {
+		input[i] = float_to_half(values[i], F);
+		widened[i] = half_to_float(input[i], F);
+	}
+	softmax_avx(widened.data(), ref.data(), K);
+
+	double t = best_time([&] { softmax_half_avx<F>(input.data(), output.data(), K); }, reps);
+	float err = 0.0f;
+	for (size_t i = 0; i < K; ++i) {
+		err = std::max(err, std::abs(output[i] - ref[i]));
+	}
+	printRow(name_f32, t, sizeof(uint16_t) + sizeof(float), K, err);
+
+	t = best_time([&] { softmax_half_avx<F>(input.data(), output_half.data(), K); }, reps);
+	err = 0.0f;
+	for (size_t i = 0; i < K; ++i) {
+		err = std::max(err, std::abs(half_to_float(output_half[i], F) - ref[i]));
+	}
+	printRow(name_half, t, 2 * sizeof(uint16_t), K, err);
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [reps]\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	int reps = (argc >= 3) ? std::stoi(argv[2]) : 5;
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(K);
+	aligned_vector<float> output(K);
+
+	std::printf("%-12s %14s %10s %14s\n", "kernel", "time(s)", "GB/s", "max_abs_err");
+	double t = best_time([&] { softmax_avx(input.data(), output.data(), K); }, reps);
+	printRow("fp32->fp32", t, 2 * sizeof(float), K, 0.0f);
+
+	run<HalfFormat::fp16>("fp16->fp32", "fp16->fp16", input, K, reps);
+	run<HalfFormat::bf16>("bf16->fp32", "bf16->bf16", input, K, reps);
+}
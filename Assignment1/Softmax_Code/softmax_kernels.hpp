@@ -0,0 +1,58 @@
+#ifndef SOFTMAX_KERNELS_HPP
+#define SOFTMAX_KERNELS_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <softmax_accumulate.hpp>
+
+// The softmax kernels of libsoftmax.a. Every kernel is compiled with the
+// flags of its program: kernel_plain.cpp with the default flags,
+// kernel_auto.cpp with the auto-vectorization flags (-ffast-math), and
+// kernel_avx.cpp with -march=native; the AVX-512 kernel comes from
+// dispatch_avx512.cpp and is used only if the CPU supports it.
+// All the kernels based on softmax_avx.hpp live in kernel_avx.cpp:
+// avx_mathfun.h defines non-inline functions and can be included by a single
+// translation unit of the library.
+void softmax_kernel_plain(const float *input, float *output, size_t K);
+void softmax_kernel_auto(const float *__restrict input, float *__restrict output, size_t K);
+void softmax_kernel_avx(const float *input, float *output, size_t K);
+void softmax_kernel_online(const float *input, float *output, size_t K);
+void softmax_kernel_stream(const float *input, float *output, size_t K);
+void softmax_kernel_stream_nt(const float *input, float *output, size_t K);
+void softmax_kernel_smallk(const float *input, float *output, size_t K);
+void softmax_kernel_par(const float *input, float *output, size_t K, int num_threads);
+
+// plain, auto and avx with the sum of the exponentials accumulated as
+// selected by A (softmax_accumulate.hpp); auto has no Accumulate::kahan
+template <Accumulate A>
+void softmax_kernel_plain_acc(const float *input, float *output, size_t K);
+template <Accumulate A>
+void softmax_kernel_auto_acc(const float *__restrict input, float *__restrict output, size_t K);
+template <Accumulate A>
+void softmax_kernel_avx_acc(const float *input, float *output, size_t K);
+
+// Common signature of the kernels in the registry, the sequential ones
+// ignore num_threads
+using softmax_fn = void (*)(const float *input, float *output, size_t K, int num_threads);
+
+// Floats moved to and from memory per element of a row of K elements, used
+// for the bandwidth of softmax_bench. A store to a line that is not in cache
+// counts twice, since the line is read before being written (write-allocate)
+using softmax_traffic_fn = double (*)(size_t K);
+
+struct SoftmaxKernel {
+	const char *name;
+	softmax_fn fn;
+	bool supported; // the CPU has the instructions used by the kernel
+	bool threaded;  // the kernel uses num_threads
+	softmax_traffic_fn traffic;
+};
+
+// All the kernels of the library, in a fixed order
+const std::vector<SoftmaxKernel> &softmax_kernels();
+
+// The kernel called name, nullptr if unknown
+const SoftmaxKernel *find_softmax_kernel(const std::string &name);
+
+#endif // SOFTMAX_KERNELS_HPP
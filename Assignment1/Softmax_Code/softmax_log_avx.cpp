@@ -0,0 +1,109 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <logsoftmax_avx.hpp>
+#include <random_fill.hpp>
+
+// Parity check and timing of log_softmax_avx and softmax_xent_avx against
+// the scalar softmax_plain followed by a log per element (the way they were
+// computed before). Returns 1 if the results differ more than the tolerance.
+
+// softmax_plain with the sum accumulated in double, so that for large K the
+// reference is not dominated by its own rounding error
+void softmax_plain(const float *input, float *output, size_t K) {
+	// Find the maximum to stabilize the computation of the exponential
+	float max_val = -std::numeric_limits<float>::infinity();
+	for (size_t i = 0; i < K; ++i) {
+		max_val = std::max(max_val, input[i]);
+	}
+
+	// computes all exponentials with the shift of max_val and the total sum
+	double sum = 0.0;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] = std::exp(input[i] - max_val);
+		sum += output[i];
+	}
+
+	// normalize by multiplying for the reciprocal of the total sum
+	const float inv_sum = 1.0 / sum;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] *= inv_sum;
+	}
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printResult(aligned_vector<float> &v, size_t K) {
+	for(size_t i=0; i<K; ++i) {
+		std::fprintf(stderr, "%f\n",v[i]);
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [label] [1]\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	size_t label = (argc >= 3) ? std::stol(argv[2]) : 0;
+	if (K == 0 || label >= K) {
+		std::cerr << "Error: K must be positive and label in [0, K)" << std::endl;
+		return 1;
+	}
+	bool print=false;
+	if (argc == 4) {
+		print=true;
+	}
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(K);
+	aligned_vector<float> output(K);
+	aligned_vector<float> ref(K);
+
+	TIMERSTART(softime_plain_log);
+	softmax_plain(input.data(), ref.data(), K);
+	for (size_t i = 0; i < K; ++i) {
+		ref[i] = std::log(ref[i]);
+	}
+	TIMERSTOP(softime_plain_log);
+
+	TIMERSTART(softime_log_softmax);
+	log_softmax_avx(input.data(), output.data(), K);
+	TIMERSTOP(softime_log_softmax);
+
+	TIMERSTART(softime_xent);
+	float loss = softmax_xent_avx(input.data(), K, label);
+	TIMERSTOP(softime_xent);
+
+	// Both are log-probabilities of order log(K): compare the absolute error
+	float max_diff = 0.0f;
+	for (size_t i = 0; i < K; ++i) {
+		max_diff = std::max(max_diff, std::abs(output[i] - ref[i]));
+	}
+	float loss_diff = std::abs(loss + ref[label]);
+	std::cout << "# cross-entropy loss (label " << label << "): " << loss << std::endl;
+	std::cout << "# max abs difference (log_softmax vs plain): " << max_diff << std::endl;
+	std::cout << "# abs difference (xent vs plain): " << loss_diff << std::endl;
+
+	// print the results on the standard output
+	if (print) {
+		printResult(output, K);
+	}
+
+	// The float lane sums of expsum_avx drift linearly with K (rounding of
+	// each addition grows with the partial sum): scale the tolerance with it
+	const float tolerance = 1e-4f * std::max(1.0f, K / float(1 << 20));
+	if (max_diff > tolerance || loss_diff > tolerance) {
+		std::cerr << "Error: parity check against softmax_plain failed" << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <masked_avx.hpp>
+#include <random_fill.hpp>
+
+// Fused temperature scaling and masking (softmax_masked_avx, with a boolean
+// and with an additive mask) against the unfused version: a pass writing the
+// scaled logits with -inf on the invalid positions, then softmax_avx.
+// About 10% of the positions are invalid. All the results are compared with
+// a scalar reference.
+
+void softmax_masked_ref(const float *input, float *output, size_t K, float temperature, const uint8_t *valid) {
+	float max_val = -std::numeric_limits<float>::infinity();
+	for (size_t i = 0; i < K; ++i) {
+		if (valid[i]) {
+			max_val = std::max(max_val, input[i] / temperature);
+		}
+	}
+	double sum = 0.0;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] = valid[i] ? std::exp(input[i] / temperature - max_val) : 0.0f;
+		sum += output[i];
+	}
+	for (size_t i = 0; i < K; ++i) {
+		output[i] /= sum;
+	}
+}
+
+// Scaled and masked copy of the logits, the extra pass the fused kernel avoids
+void scale_mask_avx(const float *input, float *scaled, size_t K, float temperature, const uint8_t *valid) {
+	const float inv_t = 1.0f / temperature;
+	for (size_t i = 0; i < K; ++i) {
+		scaled[i] = valid[i] ? input[i] * inv_t : -std::numeric_limits<float>::infinity();
+	}
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printResult(aligned_vector<float> &v, size_t K) {
+	for(size_t i=0; i<K; ++i) {
+		std::fprintf(stderr, "%f\n",v[i]);
+	}
+}
+
+float max_abs_diff(const aligned_vector<float> &a, const aligned_vector<float> &b) {
+	float diff = 0.0f;
+	for (size_t i = 0; i < a.size(); ++i) {
+		diff = std::max(diff, std::abs(a[i] - b[i]));
+	}
+	return diff;
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [T] [1]\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	float temperature = (argc >= 3) ? std::stof(argv[2]) : 0.7f;
+	bool print=false;
+	if (argc == 4) {
+		print=true;
+	}
+	if (temperature <= 0.0f) {
+		std::cerr << "Error: T must be positive" << std::endl;
+		return 1;
+	}
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(K);
+	aligned_vector<uint8_t> valid(K);
+	aligned_vector<float> bias(K);
+	std::mt19937 gen(42);
+	std::bernoulli_distribution invalid(0.1);
+	for (size_t i = 0; i < K; ++i) {
+		valid[i] = !invalid(gen);
+		bias[i] = valid[i] ? 0.0f : -std::numeric_limits<float>::infinity();
+	}
+	aligned_vector<float> ref(K), output(K), output_bias(K), output_unfused(K), scaled(K);
+	softmax_masked_ref(input.data(), ref.data(), K, temperature, valid.data());
+
+	TIMERSTART(softime_unfused);
+	scale_mask_avx(input.data(), scaled.data(), K, temperature, valid.data());
+	softmax_avx(scaled.data(), output_unfused.data(), K);
+	TIMERSTOP(softime_unfused);
+
+	TIMERSTART(softime_masked);
+	softmax_masked_avx(input.data(), output.data(), K, temperature, valid.data());
+	TIMERSTOP(softime_masked);
+
+	TIMERSTART(softime_bias);
+	softmax_masked_avx(input.data(), output_bias.data(), K, temperature, nullptr, bias.data());
+	TIMERSTOP(softime_bias);
+
+	std::cout << "# speedup (softime_unfused/softime_masked): "
+			  << deltasoftime_unfused.count() / deltasoftime_masked.count() << std::endl;
+	std::cout << "# max abs difference (masked vs ref): " << max_abs_diff(output, ref) << std::endl;
+	std::cout << "# max abs difference (bias vs ref): " << max_abs_diff(output_bias, ref) << std::endl;
+	std::cout << "# max abs difference (unfused vs ref): " << max_abs_diff(output_unfused, ref) << std::endl;
+
+	// Invalid positions must be exactly 0 in the fused kernels
+	size_t leaks = 0;
+	for (size_t i = 0; i < K; ++i) {
+		leaks += !valid[i] && (output[i] != 0.0f || output_bias[i] != 0.0f);
+	}
+	std::cout << "# nonzero invalid positions: " << leaks << std::endl;
+
+	// print the results on the standard output
+	if (print) {
+		printResult(output, K);
+	}
+}
@@ -0,0 +1,19 @@
+#ifndef SOFTMAX_NORMALIZE_HPP
+#define SOFTMAX_NORMALIZE_HPP
+
+// How the exponentials are normalized by their sum:
+//  - div:    one division per element
+//  - rcp:    1/sum computed once, one multiplication per element
+//  - rcp_nr: 1/sum from the hardware approximate reciprocal refined with one
+//            Newton-Raphson step, no division at all
+enum class Normalize { div, rcp, rcp_nr };
+
+// Mode used by the kernels when not given explicitly, it can be changed at
+// compile time with -DSOFTMAX_NORMALIZE=div|rcp|rcp_nr
+#ifndef SOFTMAX_NORMALIZE
+#define SOFTMAX_NORMALIZE rcp
+#endif
+
+constexpr Normalize default_normalize = Normalize::SOFTMAX_NORMALIZE;
+
+#endif // SOFTMAX_NORMALIZE_HPP
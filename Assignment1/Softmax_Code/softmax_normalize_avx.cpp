@@ -0,0 +1,99 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <hpc_helpers.hpp>
+#include <softmax_avx.hpp>
+#include <random_fill.hpp>
+
+// Error-vs-speed report of the normalization modes (see softmax_normalize.hpp)
+// for softmax_avx and for the scalar kernel. The error is measured against a
+// softmax computed in double precision, the time is the average over reps calls.
+
+template <Normalize N>
+void softmax_scalar(const float *input, float *output, size_t K) {
+	float max_val = -std::numeric_limits<float>::infinity();
+	for (size_t i = 0; i < K; ++i) {
+		max_val = std::max(max_val, input[i]);
+	}
+	float sum = 0.0f;
+	for (size_t i = 0; i < K; ++i) {
+		output[i] = std::exp(input[i] - max_val);
+		sum += output[i];
+	}
+	if constexpr (N == Normalize::div) {
+		for (size_t i = 0; i < K; ++i) {
+			output[i] /= sum;
+		}
+	} else {
+		const float inv_sum = 1.0f / sum;
+		for (size_t i = 0; i < K; ++i) {
+			output[i] *= inv_sum;
+		}
+	}
+}
+
+std::vector<double> softmax_reference(const std::vector<float> &input) {
+	std::vector<double> output(input.size());
+	double max_val = *std::max_element(input.begin(), input.end());
+	double sum = 0.0;
+	for (size_t i = 0; i < input.size(); ++i) {
+		output[i] = std::exp(input[i] - max_val);
+		sum += output[i];
+	}
+	for (auto &v : output) {
+		v /= sum;
+	}
+	return output;
+}
+
+using softmax_fn = void (*)(const float *, float *, size_t);
+
+void report(const char *label, softmax_fn fn, const std::vector<float> &input,
+			const std::vector<double> &ref, int reps) {
+	size_t K = input.size();
+	std::vector<float> output(K);
+	fn(input.data(), output.data(), K); // warm up
+
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < reps; ++r) {
+		fn(input.data(), output.data(), K);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	double max_rel = 0.0;
+	for (size_t i = 0; i < K; ++i) {
+		max_rel = std::max(max_rel, std::abs(output[i] - ref[i]) / ref[i]);
+	}
+	std::printf("%-16s %14.6e %14.6e\n", label, elapsed.count() / reps, max_rel);
+}
+
+std::vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	std::vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [reps]\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	int reps = (argc >= 3) ? std::stoi(argv[2]) : 10;
+	if (reps < 1) {
+		std::cerr << "Error: reps must be positive" << std::endl;
+		return 1;
+	}
+	std::vector<float> input=generate_random_input(K);
+	std::vector<double> ref = softmax_reference(input);
+
+	std::printf("%-16s %14s %14s\n", "kernel", "time(s)", "max_rel_err");
+	report("avx_div", softmax_avx<Normalize::div>, input, ref, reps);
+	report("avx_rcp", softmax_avx<Normalize::rcp>, input, ref, reps);
+	report("avx_rcp_nr", softmax_avx<Normalize::rcp_nr>, input, ref, reps);
+	report("scalar_div", softmax_scalar<Normalize::div>, input, ref, reps);
+	report("scalar_rcp", softmax_scalar<Normalize::rcp>, input, ref, reps);
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <online_avx.hpp>
+#include <random_fill.hpp>
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printResult(aligned_vector<float> &v, size_t K) {
+	for(size_t i=0; i<K; ++i) {
+		std::fprintf(stderr, "%f\n",v[i]);
+	}
+}
+
+// Bytes moved to/from memory, counting the read-for-ownership of every
+// store that is not preceded by a load of the same line:
+//  - three-pass: read input | read input, write output (+RFO) | read and write output
+//  - online:     read input | read input, write output (+RFO)
+void printTraffic(const char *label, double bytes, double seconds) {
+	std::cout << "# memory traffic (" << label << "): " << bytes / 1e6 << " MB, "
+			  << bytes / seconds / 1e9 << " GB/s" << std::endl;
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [1]\n", argv[0]);
+		return 0;
+	}
+	size_t K=0;
+	if (argc >= 2) {
+		K = std::stol(argv[1]);
+	}
+	bool print=false;
+	if (argc == 3) {
+		print=true;
+	}
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(K);
+	aligned_vector<float> output(K);
+	aligned_vector<float> output_avx(K);
+
+	TIMERSTART(softime_online);
+	softmax_online_avx(input.data(), output.data(), K);
+	TIMERSTOP(softime_online);
+	printTraffic("online", 4.0 * K * sizeof(float), deltasoftime_online.count());
+
+	TIMERSTART(softime_avx);
+	softmax_avx(input.data(), output_avx.data(), K);
+	TIMERSTOP(softime_avx);
+	printTraffic("three-pass", 6.0 * K * sizeof(float), deltasoftime_avx.count());
+
+	float max_diff = 0.0f;
+	for (size_t i = 0; i < K; ++i) {
+		max_diff = std::max(max_diff, std::abs(output[i] - output_avx[i]));
+	}
+	std::cout << "# max abs difference (online vs three-pass): " << max_diff << std::endl;
+
+	// print the results on the standard output
+	if (print) {
+		printResult(output, K);
+	}
+}
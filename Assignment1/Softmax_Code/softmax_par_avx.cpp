@@ -0,0 +1,65 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <par_avx.hpp>
+#include <random_fill.hpp>
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+void printResult(aligned_vector<float> &v, size_t K) {
+	for(size_t i=0; i<K; ++i) {
+		std::fprintf(stderr, "%f\n",v[i]);
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	if (argc == 1) {
+		std::printf("use: %s K [num_threads] [1]\n", argv[0]);
+		return 0;
+	}
+	size_t K = std::stol(argv[1]);
+	int num_threads = std::max(1u, std::thread::hardware_concurrency());
+	if (argc >= 3) {
+		num_threads = std::stoi(argv[2]);
+		if (num_threads < 1) {
+			std::cerr << "Error: num_threads must be a positive integer" << std::endl;
+			return 1;
+		}
+	}
+	bool print=false;
+	if (argc == 4) {
+		print=true;
+	}
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(K);
+	aligned_vector<float> output(K);
+	aligned_vector<float> output_avx(K);
+
+	std::cout << "Number of threads: " << num_threads << std::endl;
+
+	// Sequential reference
+	TIMERSTART(softime_avx);
+	softmax_avx(input.data(), output_avx.data(), K);
+	TIMERSTOP(softime_avx);
+
+	TIMERSTART(softime_par);
+	softmax_par_avx(input.data(), output.data(), K, num_threads);
+	TIMERSTOP(softime_par);
+
+	std::cout << "# speedup (softime_avx/softime_par): "
+			  << deltasoftime_avx.count() / deltasoftime_par.count() << std::endl;
+
+	// print the results on the standard output
+	if (print) {
+		printResult(output, K);
+	}
+}
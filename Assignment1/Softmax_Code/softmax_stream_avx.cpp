@@ -0,0 +1,61 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <stream_avx.hpp>
+#include <random_fill.hpp>
+
+// Crossover benchmark between the regular stores of softmax_avx and the
+// non-temporal stores of softmax_stream_avx: K is doubled from 2^12 up to
+// Kmax, and for every size the best time over reps calls is reported
+// together with the kernel picked by softmax_select_avx.
+
+using softmax_fn = void (*)(const float *, float *, size_t);
+
+double best_time(softmax_fn fn, const float *input, float *output, size_t K, int reps) {
+	double best = std::numeric_limits<double>::max();
+	for (int r = 0; r < reps; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		fn(input, output, K);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+
+int main(int argc, char *argv[]) {
+	size_t Kmax = (argc >= 2) ? std::stol(argv[1]) : (1 << 26);
+	int reps = (argc >= 3) ? std::stoi(argv[2]) : 5;
+	if (argc == 1) {
+		std::printf("use: %s [Kmax] [reps] (defaults: %zu %d)\n", argv[0], Kmax, reps);
+	}
+
+	// buffers larger than 2MB are backed by transparent huge pages
+	use_huge_pages = true;
+	aligned_vector<float> input=generate_random_input(Kmax);
+	aligned_vector<float> output(Kmax);
+
+	std::cout << "# stream threshold (input+output): " << stream_threshold() << " bytes" << std::endl;
+	std::printf("%12s %14s %14s %10s %10s %8s\n",
+				"K", "storeu(s)", "stream(s)", "storeu_GB/s", "stream_GB/s", "select");
+	for (size_t K = 1 << 12; K <= Kmax; K *= 2) {
+		double t_storeu = best_time(softmax_avx<default_normalize>, input.data(), output.data(), K, reps);
+		double t_stream = best_time(softmax_stream_avx<default_normalize>, input.data(), output.data(), K, reps);
+
+		// Bytes the kernel must move at least: input read twice, output written
+		// once and read/written once more by the normalization pass
+		double bytes = 5.0 * K * sizeof(float);
+		bool stream = 2 * K * sizeof(float) > stream_threshold();
+		std::printf("%12zu %14.6e %14.6e %10.2f %10.2f %8s\n", K, t_storeu, t_stream,
+					bytes / t_storeu / 1e9, bytes / t_stream / 1e9, stream ? "stream" : "storeu");
+	}
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <hpc_helpers.hpp>
+#include <aligned_allocator.hpp>
+#include <topk_avx.hpp>
+#include <random_fill.hpp>
+
+// Top-k / top-p selection on the logits (softmax_topk_avx) against the
+// current approach: softmax_avx over the whole vector, then partial_sort of
+// the indices by probability and top-p over the best k. K is doubled from 32k
+// to 256k; best time over reps calls, and check that both select the same
+// logits with the same probabilities.
+
+// Same result as softmax_topk_avx, through the full softmax output
+size_t softmax_topk_full(const float *logits, float *output, uint32_t *order, size_t K, size_t k, float top_p,
+						 uint32_t *indices, float *probs) {
+	k = std::min(k, K);
+	softmax_avx(logits, output, K);
+	std::iota(order, order + K, 0);
+	std::partial_sort(order, order + k, order + K,
+					  [&](uint32_t a, uint32_t b) { return output[a] > output[b]; });
+
+	// renormalize over the best k, then keep the top-p prefix
+	float sum = 0.0f;
+	for (size_t i = 0; i < k; ++i) {
+		sum += output[order[i]];
+	}
+	size_t keep = k;
+	float cumulative = 0.0f;
+	for (size_t i = 0; i < k; ++i) {
+		indices[i] = order[i];
+		probs[i] = output[order[i]] / sum;
+		cumulative += probs[i];
+		if (top_p < 1.0f && cumulative >= top_p) {
+			keep = i + 1;
+			break;
+		}
+	}
+	float kept = std::accumulate(probs, probs + keep, 0.0f);
+	for (size_t i = 0; i < keep; ++i) {
+		probs[i] /= kept;
+	}
+	return keep;
+}
+
+template <typename F>
+double best_time(F &&fn, int reps) {
+	double best = std::numeric_limits<double>::max();
+	for (int r = 0; r < reps; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+aligned_vector<float> generate_random_input(size_t K, float min = -1.0f, float max = 1.0f) {
+	aligned_vector<float> input(K);
+	random_fill_uniform(input.data(), K, 5489, min, max); // fixed seed for reproducible results
+	return input;
+}
+
+
+int main(int argc, char *argv[]) {
+	size_t k = (argc >= 2) ? std::stol(argv[1]) : 50;
+	float top_p = (argc >= 3) ? std::stof(argv[2]) : 0.9f;
+	int reps = (argc >= 4) ? std::stoi(argv[3]) : 5;
+	if (argc == 1) {
+		std::printf("use: %s [k] [top_p] [reps] (defaults: %zu %g %d)\n", argv[0], k, top_p, reps);
+	}
+	if (k == 0 || top_p <= 0.0f || top_p > 1.0f) {
+		std::cerr << "Error: k must be positive and top_p in (0, 1]" << std::endl;
+		return 1;
+	}
+
+	const size_t Kmax = 1 << 18;
+	// logits spread as in a language model head, a few clearly above the rest
+	aligned_vector<float> logits = generate_random_input(Kmax, -8.0f, 8.0f);
+	aligned_vector<float> output(Kmax);
+	std::vector<uint32_t> order(Kmax), indices_full(k), indices_topk(k);
+	std::vector<float> probs_full(k), probs_topk(k);
+
+	std::printf("%8s %6s %14s %14s %8s %6s %12s\n", "K", "kept", "full(s)", "topk(s)", "speedup", "match", "max_diff");
+	for (size_t K = 1 << 15; K <= Kmax; K *= 2) {
+		size_t n_full = 0, n_topk = 0;
+		double t_full = best_time([&] {
+			n_full = softmax_topk_full(logits.data(), output.data(), order.data(), K, k, top_p,
+									   indices_full.data(), probs_full.data());
+		}, reps);
+		double t_topk = best_time([&] {
+			n_topk = softmax_topk_avx(logits.data(), K, k, top_p, indices_topk.data(), probs_topk.data());
+		}, reps);
+
+		bool match = n_full == n_topk;
+		float max_diff = 0.0f;
+		for (size_t i = 0; match && i < n_topk; ++i) {
+			// equal logits may be selected in a different order
+			match = logits[indices_full[i]] == logits[indices_topk[i]];
+			max_diff = std::max(max_diff, std::abs(probs_full[i] - probs_topk[i]));
+		}
+		std::printf("%8zu %6zu %14.6e %14.6e %8.2f %6s %12.4e\n", K, n_topk, t_full, t_topk,
+					t_full / t_topk, match ? "yes" : "no", max_diff);
+	}
+}
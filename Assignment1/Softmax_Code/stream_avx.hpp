@@ -0,0 +1,79 @@
+#ifndef STREAM_AVX_HPP
+#define STREAM_AVX_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <unistd.h>
+#include <softmax_avx.hpp>
+
+// softmax_avx with non-temporal stores for the final write of the output:
+// when input and output do not fit in the last level cache, regular stores
+// keep dirty lines that evict useful data and are written back later anyway.
+// The exponentials are still stored normally, since the normalization pass
+// reads them back right after (streaming them too was measured slower).
+// _mm256_stream_ps needs a 32-byte aligned address, so the elements before
+// the first aligned output address (head) and after the last full vector
+// (tail) are handled with masked stores.
+template <Normalize N = default_normalize>
+inline void softmax_stream_avx(const float *input, float *output, size_t K) {
+	const __m256 lowest = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+	size_t head = std::min(K, ((32 - (uintptr_t)output % 32) % 32) / sizeof(float));
+	size_t body_end = K - (K - head) % 8;
+	__m256i head_mask = tail_mask_avx(head);
+	__m256i tail_mask = tail_mask_avx(K - body_end);
+	__m256 head_mask_ps = _mm256_castsi256_ps(head_mask);
+	__m256 tail_mask_ps = _mm256_castsi256_ps(tail_mask);
+
+	// Find the maximum to stabilize the computation of the exponential,
+	// masked-out lanes of head and tail are set to lowest
+	__m256 head_val = _mm256_blendv_ps(lowest, _mm256_maskload_ps(input, head_mask), head_mask_ps);
+	__m256 tail_val = _mm256_blendv_ps(lowest, _mm256_maskload_ps(input + body_end, tail_mask), tail_mask_ps);
+	__m256 max_val = _mm256_max_ps(head_val, tail_val);
+	for (size_t i = head; i < body_end; i += 8) {
+		max_val = _mm256_max_ps(max_val, _mm256_loadu_ps(input + i));
+	}
+	__m256 max_input_vec = _mm256_set1_ps(hmax_avx(max_val));
+
+	// Computes all exponentials with the shift of max_val and the total sum
+	__m256 exp_head = _mm256_and_ps(exp256_ps(_mm256_sub_ps(head_val, max_input_vec)), head_mask_ps);
+	__m256 exp_tail = _mm256_and_ps(exp256_ps(_mm256_sub_ps(tail_val, max_input_vec)), tail_mask_ps);
+	__m256 sum_vec = _mm256_add_ps(exp_head, exp_tail);
+	for (size_t i = head; i < body_end; i += 8) {
+		__m256 exp_val = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(input + i), max_input_vec));
+		_mm256_store_ps(output + i, exp_val);
+		sum_vec = _mm256_add_ps(sum_vec, exp_val);
+	}
+
+	// Normalize by the total sum, head and tail are still in registers
+	__m256 sum_vect = norm_factor_avx<N>(hsum_avx(sum_vec));
+	_mm256_maskstore_ps(output, head_mask, normalize_avx<N>(exp_head, sum_vect));
+	for (size_t i = head; i < body_end; i += 8) {
+		_mm256_stream_ps(output + i, normalize_avx<N>(_mm256_load_ps(output + i), sum_vect));
+	}
+	_mm256_maskstore_ps(output + body_end, tail_mask, normalize_avx<N>(exp_tail, sum_vect));
+
+	// Make the streamed data visible to other threads
+	_mm_sfence();
+}
+
+// Bytes of input + output above which softmax_select_avx uses streaming
+// stores: the size of the last level cache, or 32 MB if it is unknown
+inline size_t stream_threshold() {
+	static const size_t threshold = [] {
+		long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+		return (llc > 0) ? (size_t)llc : (size_t)(32 << 20);
+	}();
+	return threshold;
+}
+
+// softmax_avx for outputs that fit in the cache, softmax_stream_avx above
+template <Normalize N = default_normalize>
+inline void softmax_select_avx(const float *input, float *output, size_t K) {
+	if (2 * K * sizeof(float) <= stream_threshold()) {
+		softmax_avx<N>(input, output, K);
+	} else {
+		softmax_stream_avx<N>(input, output, K);
+	}
+}
+
+#endif // STREAM_AVX_HPP
@@ -0,0 +1,105 @@
+#ifndef TOPK_AVX_HPP
+#define TOPK_AVX_HPP
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <softmax_avx.hpp>
+
+// Top-k / top-p (nucleus) selection directly on the logits, without
+// computing and sorting the full softmax output.
+// The logits are scanned 8 at a time against a threshold, the smallest logit
+// of the current top k: a single compare + movemask discards a whole vector,
+// and only the logits above the threshold are appended to a candidate buffer.
+// When the buffer holds 2k candidates it is cut back to the best k with
+// nth_element and the threshold is raised. At the end the k survivors are
+// sorted, the softmax is computed over them only, and the shortest prefix
+// whose probability reaches top_p is kept and renormalized.
+
+struct TopkCandidate {
+	float logit;
+	uint32_t index;
+};
+
+inline bool topk_greater(const TopkCandidate &a, const TopkCandidate &b) {
+	return a.logit > b.logit;
+}
+
+// Keeps the k largest candidates and returns the smallest of them
+inline float topk_compact(std::vector<TopkCandidate> &candidates, size_t k) {
+	std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end(), topk_greater);
+	candidates.resize(k);
+	return candidates[k - 1].logit;
+}
+
+// Writes in indices/probs (at least k elements) the selected positions in
+// decreasing order of probability and returns how many they are.
+// probs are renormalized over the selected positions. top_p = 1 keeps all the
+// top k. Among equal logits the selected positions are arbitrary.
+inline size_t softmax_topk_avx(const float *logits, size_t K, size_t k, float top_p,
+							   uint32_t *indices, float *probs) {
+	k = std::min(k, K);
+	if (k == 0) {
+		return 0;
+	}
+	std::vector<TopkCandidate> candidates;
+	candidates.reserve(2 * k + 8);
+	float threshold = -std::numeric_limits<float>::infinity();
+	__m256 threshold_vec = _mm256_set1_ps(threshold);
+
+	size_t K8 = K - (K % 8);
+	for (size_t i = 0; i < K8; i += 8) {
+		__m256 x = _mm256_loadu_ps(logits + i);
+		int above = _mm256_movemask_ps(_mm256_cmp_ps(x, threshold_vec, _CMP_GT_OQ));
+		if (above == 0) {
+			continue;
+		}
+		while (above) {
+			int j = __builtin_ctz(above);
+			candidates.push_back({logits[i + j], uint32_t(i + j)});
+			above &= above - 1;
+		}
+		if (candidates.size() >= 2 * k) {
+			threshold = topk_compact(candidates, k);
+			threshold_vec = _mm256_set1_ps(threshold);
+		}
+	}
+	for (size_t i = K8; i < K; ++i) {
+		if (logits[i] > threshold) {
+			candidates.push_back({logits[i], uint32_t(i)});
+		}
+	}
+	if (candidates.size() > k) {
+		topk_compact(candidates, k);
+	}
+	std::sort(candidates.begin(), candidates.end(), topk_greater);
+	size_t n = candidates.size();
+
+	// Softmax over the survivors only
+	std::vector<float> top_logits(n);
+	for (size_t i = 0; i < n; ++i) {
+		top_logits[i] = candidates[i].logit;
+		indices[i] = candidates[i].index;
+	}
+	softmax_avx(top_logits.data(), probs, n);
+
+	// Nucleus: shortest prefix with cumulative probability >= top_p
+	size_t keep = n;
+	if (top_p < 1.0f) {
+		float cumulative = 0.0f;
+		for (size_t i = 0; i < n; ++i) {
+			cumulative += probs[i];
+			if (cumulative >= top_p) {
+				keep = i + 1;
+				break;
+			}
+		}
+		float inv = 1.0f / std::accumulate(probs, probs + keep, 0.0f);
+		for (size_t i = 0; i < keep; ++i) {
+			probs[i] *= inv;
+		}
+	}
+	return keep;
+}
+
+#endif // TOPK_AVX_HPP
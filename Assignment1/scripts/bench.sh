@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Nome del file di output
+OUTPUT_FILE="bench_results.csv"
+
+# Valori di K da testare (gli stessi di time_*.sh)
+K_VALUES="100,200,300,400,500,600,700,800,900,1000"
+
+# Il benchmark ripete ogni misura fino a stabilita' statistica e scrive
+# direttamente un CSV (mediana, p99, cicli per elemento, GB/s)
+./softmax_bench -k plain,auto,avx -s "$K_VALUES" -f csv > "$OUTPUT_FILE"
+
+# Dimensioni di default: una per livello di cache e una in DRAM
+./softmax_bench -k plain,auto,avx -f csv | tail -n +2 >> "$OUTPUT_FILE"
+
+echo "Test completato. I risultati sono in $OUTPUT_FILE"
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# Nome del file di output
+OUTPUT_FILE="accumulate_results.csv"
+
+# Un K in cache e uno grande, dove l'errore della somma in float si vede
+K_VALUES="131072,20000000"
+
+# Costo in throughput dei modi di accumulazione della somma
+./softmax_bench -k plain_flt,plain_kahan,plain_blocked,plain_f64,auto_flt,auto_blocked,auto_f64,avx_flt,avx_kahan,avx_blocked,avx_f64 \
+    -s "$K_VALUES" -f csv > "$OUTPUT_FILE"
+
+# Errore relativo rispetto alla somma in double del kernel plain
+./softmax --impl plain_f64,plain_flt,plain_kahan,plain_blocked,auto_flt,auto_blocked,auto_f64,avx_flt,avx_kahan,avx_blocked,avx_f64 20000000 \
+    | grep "rel difference"
+
+echo "Test completato. I risultati sono in $OUTPUT_FILE"
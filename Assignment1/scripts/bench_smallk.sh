@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# Nome del file di output
+OUTPUT_FILE="smallk_results.csv"
+
+# Valori piccoli di K, multipli di 8 e non
+K_VALUES="1,4,7,8,10,16,17,24,32,33,48,63,64,96,100,127,128"
+
+# Kernel generico (softmax_avx) contro i kernel specializzati per K
+./softmax_bench -k avx,smallk -s "$K_VALUES" -f csv > "$OUTPUT_FILE"
+
+echo "Test completato. I risultati sono in $OUTPUT_FILE"
@@ -12,7 +12,7 @@ declare -a K_VALUES=(100 200 600 1000)
 # Esegue il comando per ogni valore di K e salva l'output
 for K in "${K_VALUES[@]}"; do
     echo "\nK=$K" >> "$OUTPUT_FILE"
-    ./softmax_auto "$K" 1 2>> "$OUTPUT_FILE"
+    ./softmax --impl auto "$K" 1 2>> "$OUTPUT_FILE"
 done
 
 echo "Risultati salvati in $OUTPUT_FILE"
\ No newline at end of file
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# Nome del file di output
+OUTPUT_FILE="batched_node_results.txt"
+
+# Numero di righe della matrice e di thread della versione batched
+ROWS=4000
+THREADS=1
+
+# Pulisce il file di output
+echo "K Batched(s) AvxLoop(s) Speedup" > "$OUTPUT_FILE"
+
+# Array con i valori di K da testare
+K_VALUES=(100 200 300 400 500 600 700 800 900 1000)
+
+# Loop sui valori di K
+for K in "${K_VALUES[@]}"; do
+    for i in {1..10}; do
+        # Esegue il programma e salva i tempi mediani delle due versioni
+        OUT=$(./softmax_batched_avx "$ROWS" "$K" "$THREADS")
+        TIME_BATCHED=$(echo "$OUT" | grep "softime_batched" | awk '{print substr($5, 1, length($5)-1)}')
+        TIME_LOOP=$(echo "$OUT" | grep "softime_avx_loop" | awk '{print substr($5, 1, length($5)-1)}')
+        SPEEDUP=$(echo "$OUT" | grep "speedup" | awk '{print $4}')
+        echo "$K $TIME_BATCHED $TIME_LOOP $SPEEDUP" >> "$OUTPUT_FILE"
+    done
+done
+
+echo "Test completato. I risultati sono in $OUTPUT_FILE"
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# Nome del file di output
+OUTPUT_FILE="online_node_results.txt"
+
+# Pulisce il file di output
+echo "K Online(s) ThreePass(s) Online(GB/s) ThreePass(GB/s)" > "$OUTPUT_FILE"
+
+# Array con i valori di K da testare (da dati in cache fino a dati in memoria)
+K_VALUES=(1000 10000 100000 1000000 10000000 100000000)
+
+# Loop sui valori di K
+for K in "${K_VALUES[@]}"; do
+    for i in {1..10}; do
+        # Esegue il programma e salva tempi e banda delle due versioni
+        OUT=$(./softmax_online_avx "$K")
+        TIME_ONLINE=$(echo "$OUT" | grep "(softime_online)" | awk '{print substr($5, 1, length($5)-1)}')
+        TIME_AVX=$(echo "$OUT" | grep "(softime_avx)" | awk '{print substr($5, 1, length($5)-1)}')
+        BW_ONLINE=$(echo "$OUT" | grep "traffic (online)" | awk '{print $7}')
+        BW_AVX=$(echo "$OUT" | grep "traffic (three-pass)" | awk '{print $7}')
+        echo "$K $TIME_ONLINE $TIME_AVX $BW_ONLINE $BW_AVX" >> "$OUTPUT_FILE"
+    done
+done
+
+echo "Test completato. I risultati sono in $OUTPUT_FILE"
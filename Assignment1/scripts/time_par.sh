@@ -0,0 +1,27 @@
+#!/bin/bash
+
+# Nome del file di output
+OUTPUT_FILE="par_node_results.txt"
+
+# Dimensione del vettore
+K=50000000
+
+# Pulisce il file di output
+echo "Threads Avx(s) Par(s) Speedup" > "$OUTPUT_FILE"
+
+# Array con il numero di thread da testare
+THREADS=(1 2 4 8 16 32)
+
+# Loop sul numero di thread
+for T in "${THREADS[@]}"; do
+    for i in {1..10}; do
+        # Esegue il programma e salva i tempi di esecuzione e lo speedup
+        OUT=$(./softmax_par_avx "$K" "$T")
+        TIME_AVX=$(echo "$OUT" | grep "softime_avx" | awk '{print substr($5, 1, length($5)-1)}')
+        TIME_PAR=$(echo "$OUT" | grep "softime_par" | awk '{print substr($5, 1, length($5)-1)}')
+        SPEEDUP=$(echo "$OUT" | grep "speedup" | awk '{print $4}')
+        echo "$T $TIME_AVX $TIME_PAR $SPEEDUP" >> "$OUTPUT_FILE"
+    done
+done
+
+echo "Test completato. I risultati sono in $OUTPUT_FILE"
@@ -13,7 +13,7 @@ K_VALUES=(100 200 300 400 500 600 700 800 900 1000)
 for K in "${K_VALUES[@]}"; do
     for i in {1..10}; do
         # Esegue il programma e salva il tempo di esecuzione
-        TIME_MS=$(./softmax_plain "$K" | grep "softime_plain" | awk '{print substr($5, 1, length($5)-1)}')
+        TIME_MS=$(./softmax --impl plain "$K" | grep "softime_plain" | awk '{print substr($5, 1, length($5)-1)}')
         echo "$K $TIME_MS" >> "$OUTPUT_FILE"
     done
 done
@@ -0,0 +1,120 @@
+#ifndef COLLATZ_CACHE_HPP
+#define COLLATZ_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+using ull = unsigned long long;
+
+// Default bound of the cache: 2^24 entries of 2 bytes (32 MB)
+constexpr ull COLLATZ_CACHE_BOUND = 1ULL << 24;
+
+// Per-thread statistics, added to the cache at the end of the work
+struct CollatzCounters {
+    ull lookups = 0;  // reads of the cache
+    ull hits = 0;     // reads that found the steps, stopping the trajectory
+    ull steps = 0;    // steps of all the numbers evaluated
+    ull cached = 0;   // steps taken from the cache instead of computed
+};
+
+// Number of steps of every n below a bound, filled while the trajectories
+// are computed. A trajectory stops at the first number below the bound
+// whose steps are known; then the steps of all the numbers below the bound
+// met along the way are stored, so the trajectories of the next numbers
+// stop even earlier.
+// The entries are 16-bit atomics, 0 = unknown. 16 bits are enough for any
+// bound: at 2 bytes per entry the table cannot go much beyond 2^40 entries,
+// and every n below 2^68 (the verified range of the conjecture) reaches 1
+// in less than 3000 steps. A count above 65535 would just not be stored.
+// The entries are read and written with relaxed ordering and no locks: two
+// threads can only write the same value, and a thread that does not see
+// the value of another one just computes it again.
+// The table is allocated with calloc, so its pages are mapped lazily and only
+// the ones touched use memory. bound = 0 disables the cache.
+class CollatzCache {
+public:
+    explicit CollatzCache(ull bound) : bound(bound), table(nullptr) {
+        static_assert(sizeof(std::atomic<uint16_t>) == sizeof(uint16_t) &&
+                      std::atomic<uint16_t>::is_always_lock_free,
+                      "std::atomic<uint16_t> must be a plain lock-free uint16_t");
+        if (bound > 0) {
+            table = static_cast<std::atomic<uint16_t> *>(std::calloc(bound, sizeof(uint16_t)));
+            if (!table) throw std::bad_alloc();
+        }
+    }
+
+    ~CollatzCache() { std::free(table); }
+
+    CollatzCache(const CollatzCache &) = delete;
+    CollatzCache &operator=(const CollatzCache &) = delete;
+
+    // Number of steps of the Collatz sequence of n (n >= 1)
+    ull steps(ull n, CollatzCounters &counters) {
+        // Numbers below the bound met along the trajectory, with their
+        // distance from n
+        constexpr int MAX_PATH = 64;
+        ull path[MAX_PATH];
+        ull path_steps[MAX_PATH];
+        int path_len = 0;
+
+        ull steps = 0;
+        while (n != 1) {
+            if (n < bound) {
+                ++counters.lookups;
+                uint16_t known = table[n].load(std::memory_order_relaxed);
+                if (known != 0) {
+                    steps += known;
+                    ++counters.hits;
+                    counters.cached += known;
+                    break;
+                }
+                if (path_len < MAX_PATH) {
+                    path[path_len] = n;
+                    path_steps[path_len++] = steps;
+                }
+            }
+            n = (n % 2 == 0) ? n / 2 : 3 * n + 1;
+            steps++;
+        }
+        for (int i = 0; i < path_len; ++i) {
+            if (steps - path_steps[i] <= UINT16_MAX) {
+                table[path[i]].store((uint16_t)(steps - path_steps[i]), std::memory_order_relaxed);
+            }
+        }
+        counters.steps += steps;
+        return steps;
+    }
+
+    // Adds the counters of a thread to the totals
+    void add(const CollatzCounters &counters) {
+        lookups.fetch_add(counters.lookups, std::memory_order_relaxed);
+        hits.fetch_add(counters.hits, std::memory_order_relaxed);
+        steps_total.fetch_add(counters.steps, std::memory_order_relaxed);
+        steps_cached.fetch_add(counters.cached, std::memory_order_relaxed);
+    }
+
+    // Fraction of the reads of the cache that found the steps
+    double hit_rate() const {
+        ull l = lookups.load();
+        return l ? (double)hits.load() / l : 0.0;
+    }
+
+    // Fraction of the steps taken from the cache instead of computed
+    double cached_fraction() const {
+        ull s = steps_total.load();
+        return s ? (double)steps_cached.load() / s : 0.0;
+    }
+
+    const ull bound;
+
+private:
+    std::atomic<uint16_t> *table;
+    std::atomic<ull> lookups{0};
+    std::atomic<ull> hits{0};
+    std::atomic<ull> steps_total{0};
+    std::atomic<ull> steps_cached{0};
+};
+
+#endif // COLLATZ_CACHE_HPP
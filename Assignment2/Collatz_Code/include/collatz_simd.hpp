@@ -0,0 +1,117 @@
+#ifndef COLLATZ_SIMD_HPP
+#define COLLATZ_SIMD_HPP
+
+#include <algorithm>
+#include <collatz_cache.hpp>
+#if defined(__AVX512F__) || defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+// Maximum number of Collatz steps of the numbers produced by next(n) (a
+// callable returning false when there are no more numbers), advancing
+// COLLATZ_LANES trajectories at a time in the 64-bit lanes of a vector.
+// A step has no branch: the odd lanes go to (3n+1)/2 (two steps), the even
+// ones to n/2, and the two results are blended. A lane retires as soon as
+// its number falls below the bound of the cache (below 2 without cache):
+// the rest of its steps is computed by CollatzCache::steps, which also fills
+// the cache, the total goes into the maximum and the lane is refilled with
+// the next number. When next has no more numbers, the lanes left are run
+// to the end. Without AVX2 the numbers are evaluated one at a time.
+// The numbers above 2^63 are not supported (the comparisons of AVX2 are
+// signed and 3n+1 is not checked for overflow, as in the scalar version).
+
+#if defined(__AVX512F__)
+    constexpr int COLLATZ_LANES = 8;
+#elif defined(__AVX2__)
+    constexpr int COLLATZ_LANES = 4;
+#else
+    constexpr int COLLATZ_LANES = 1;
+#endif
+
+template <typename Next>
+ull collatz_max_simd(Next next, CollatzCache &cache, CollatzCounters &counters) {
+    ull max_steps = 0;
+#if defined(__AVX512F__) || defined(__AVX2__)
+    alignas(64) ull n[COLLATZ_LANES];
+    alignas(64) ull steps[COLLATZ_LANES];
+    const ull threshold = std::max<ull>(cache.bound, 2);
+
+    // Lanes without a number hold 0, which stays 0 and is never retired
+    unsigned active = 0;
+    for (int l = 0; l < COLLATZ_LANES; ++l) {
+        steps[l] = 0;
+        n[l] = 0;
+        if (next(n[l])) active |= 1u << l;
+    }
+
+    // Completes the trajectory of lane l and puts the next number in it
+    auto retire = [&](int l) {
+        ull rest = cache.steps(n[l], counters);
+        counters.steps += steps[l];
+        max_steps = std::max(max_steps, steps[l] + rest);
+        steps[l] = 0;
+        n[l] = 0;
+        if (!next(n[l])) active &= ~(1u << l);
+    };
+
+#if defined(__AVX512F__)
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i thr = _mm512_set1_epi64(threshold);
+    __m512i vn = _mm512_load_si512(n);
+    __m512i vsteps = _mm512_load_si512(steps);
+    while (active) {
+        unsigned done = _mm512_cmplt_epu64_mask(vn, thr) & active;
+        if (done) {
+            _mm512_store_si512(n, vn);
+            _mm512_store_si512(steps, vsteps);
+            for (int l = 0; l < COLLATZ_LANES; ++l) {
+                if (done & (1u << l)) retire(l);
+            }
+            vn = _mm512_load_si512(n);
+            vsteps = _mm512_load_si512(steps);
+            continue;
+        }
+        // odd: n/2 + n + 1 = (3n+1)/2, even: n/2
+        __mmask8 odd = _mm512_test_epi64_mask(vn, one);
+        // (the zero-masking form avoids a false -Wmaybe-uninitialized of GCC 12)
+        __m512i half = _mm512_maskz_srli_epi64(0xFF, vn, 1);
+        vn = _mm512_mask_add_epi64(half, odd, half, _mm512_add_epi64(vn, one));
+        vsteps = _mm512_add_epi64(vsteps, one);
+        vsteps = _mm512_mask_add_epi64(vsteps, odd, vsteps, one);
+    }
+#else
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i thr = _mm256_set1_epi64x(threshold);
+    __m256i vn = _mm256_load_si256((const __m256i *)n);
+    __m256i vsteps = _mm256_load_si256((const __m256i *)steps);
+    while (active) {
+        unsigned done = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(thr, vn))) & active;
+        if (done) {
+            _mm256_store_si256((__m256i *)n, vn);
+            _mm256_store_si256((__m256i *)steps, vsteps);
+            for (int l = 0; l < COLLATZ_LANES; ++l) {
+                if (done & (1u << l)) retire(l);
+            }
+            vn = _mm256_load_si256((const __m256i *)n);
+            vsteps = _mm256_load_si256((const __m256i *)steps);
+            continue;
+        }
+        // odd: n/2 + n + 1 = (3n+1)/2, even: n/2. odd is all ones (-1) in
+        // the odd lanes, so 1 - odd is the number of steps
+        __m256i odd = _mm256_cmpeq_epi64(_mm256_and_si256(vn, one), one);
+        __m256i half = _mm256_srli_epi64(vn, 1);
+        __m256i odd_next = _mm256_add_epi64(half, _mm256_add_epi64(vn, one));
+        vn = _mm256_blendv_epi8(half, odd_next, odd);
+        vsteps = _mm256_add_epi64(vsteps, _mm256_sub_epi64(one, odd));
+    }
+#endif
+#else
+    ull n;
+    while (next(n)) {
+        max_steps = std::max(max_steps, cache.steps(n, counters));
+    }
+#endif
+    return max_steps;
+}
+
+#endif // COLLATZ_SIMD_HPP
@@ -6,12 +6,120 @@
 
 #ifndef __CUDACC__
     #include <chrono>
+    #include <atomic>
+    #include <cstdio>
+    #include <cstdlib>
+    #include <map>
+    #include <mutex>
+    #include <string>
+#endif
+
+#ifndef __CUDACC__
+// Statistics of a timed label over all its calls, from any thread: number of
+// calls and total, minimum and maximum time in nanoseconds. Updated with
+// relaxed atomics, without locks.
+struct timer_stats {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> min{UINT64_MAX};
+    std::atomic<uint64_t> max{0};
+
+    void add(uint64_t ns) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t m = min.load(std::memory_order_relaxed);
+        while (ns < m && !min.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+        m = max.load(std::memory_order_relaxed);
+        while (ns > m && !max.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+    }
+};
+
+// Statistics of all the labels timed by the program (TIMERSTOP and
+// SCOPED_TIMER). If the HPC_TIMERS environment variable is set, at exit the
+// summary is appended as CSV to that file (with the header only if the file
+// is empty), or written to stderr with HPC_TIMERS=-, so that scripts do not
+// need to parse the "# elapsed time" lines.
+class timer_registry {
+public:
+    static timer_registry &instance() {
+        static timer_registry registry;
+        return registry;
+    }
+
+    // The reference stays valid until exit
+    timer_stats &stats(const std::string &label) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_[label];
+    }
+
+    void record(const std::string &label, std::chrono::steady_clock::duration d) {
+        stats(label).add(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    ~timer_registry() {
+        const char *path = std::getenv("HPC_TIMERS");
+        if (!path || stats_.empty()) return;
+        FILE *out = std::string(path) == "-" ? stderr : std::fopen(path, "a");
+        if (!out) {
+            std::fprintf(stderr, "Error: cannot open %s\n", path);
+            return;
+        }
+        std::fseek(out, 0, SEEK_END);
+        if (out == stderr || std::ftell(out) <= 0) {
+            std::fprintf(out, "label,count,total_s,min_s,mean_s,max_s\n");
+        }
+        for (const auto &[label, s] : stats_) {
+            const uint64_t count = s.count.load();
+            if (count == 0) continue;
+            std::fprintf(out, "%s,%llu,%.9g,%.9g,%.9g,%.9g\n", label.c_str(), (unsigned long long)count,
+                         s.total.load() * 1e-9, s.min.load() * 1e-9, s.total.load() * 1e-9 / count,
+                         s.max.load() * 1e-9);
+        }
+        if (out != stderr) std::fclose(out);
+    }
+
+private:
+    timer_registry() = default;
+    timer_registry(const timer_registry &) = delete;
+    timer_registry &operator=(const timer_registry &) = delete;
+
+    std::mutex mutex_;
+    std::map<std::string, timer_stats> stats_;
+};
+
+// Adds the lifetime of the object to the statistics of a label, without
+// printing anything. steady_clock::now() costs a few tens of ns (vDSO).
+class scoped_timer {
+public:
+    explicit scoped_timer(timer_stats &stats)
+        : stats_(stats), start_(std::chrono::steady_clock::now()) {}
+    explicit scoped_timer(const std::string &label)
+        : scoped_timer(timer_registry::instance().stats(label)) {}
+
+    ~scoped_timer() {
+        auto d = std::chrono::steady_clock::now() - start_;
+        stats_.add(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    scoped_timer(const scoped_timer &) = delete;
+    scoped_timer &operator=(const scoped_timer &) = delete;
+
+private:
+    timer_stats &stats_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Times the rest of the enclosing scope; the label is looked up only once
+    #define SCOPED_TIMER(label)                                                \
+        static timer_stats &stats##label =                                     \
+                                 timer_registry::instance().stats(#label);     \
+        scoped_timer scoped##label(stats##label);
 #endif
 
 #ifndef __CUDACC__
     #define TIMERSTART(label)                                                  \
-        std::chrono::time_point<std::chrono::system_clock> a##label, b##label; \
-        a##label = std::chrono::system_clock::now();
+        std::chrono::time_point<std::chrono::steady_clock> a##label, b##label; \
+        a##label = std::chrono::steady_clock::now();
 
 #else
     #define TIMERSTART(label)                                                  \
@@ -24,10 +132,11 @@
 
 #ifndef __CUDACC__
     #define TIMERSTOP(label)                                                   \
-        b##label = std::chrono::system_clock::now();                           \
+        b##label = std::chrono::steady_clock::now();                           \
         std::chrono::duration<double> delta##label = b##label-a##label;        \
         std::cout << "# elapsed time ("<< #label <<"): "                       \
-                  << delta##label.count()  << "s" << std::endl;
+                  << delta##label.count()  << "s" << std::endl;                \
+        timer_registry::instance().record(#label, b##label-a##label);
 
 #define TIMERSUM(label1, label2)				                               \
 	    std::chrono::duration<double> s##label1##label2 =                      \
@@ -50,6 +159,127 @@
 #endif
 
 
+// Hardware performance counters of a labeled region through perf_event_open,
+// compiled in with -DHPC_PERF (make PERF=1), otherwise PERFSTART/PERFSTOP
+// expand to nothing. PERFSTOP prints cycles, instructions, IPC, LLC misses
+// (also per element, if elements > 0) and vector instructions.
+// Only user space is counted (enough with perf_event_paranoid <= 2). Threads
+// created inside the region are counted once joined, threads of a pool
+// created before it (e.g. OpenMP) are not. Vector instructions are the raw
+// event in the HPC_PERF_VECTOR environment variable (hex), by default the
+// Intel FP_ARITH_INST_RETIRED packed 128/256/512-bit (0xfcc7), which other
+// CPUs encode differently. Counters that cannot be opened print n/a.
+#if defined(HPC_PERF) && defined(__linux__) && !defined(__CUDACC__)
+    #include <cstring>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+
+class perf_counters {
+public:
+    enum event { CYCLES, INSTRUCTIONS, LLC_MISSES, VECTOR, NUM_EVENTS };
+
+    perf_counters() {
+        const char *vector = std::getenv("HPC_PERF_VECTOR");
+        open_event(CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open_event(INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open_event(LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        open_event(VECTOR, PERF_TYPE_RAW, vector ? std::strtoull(vector, nullptr, 16) : 0xfcc7);
+    }
+
+    ~perf_counters() {
+        for (int fd : fd_) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    perf_counters(const perf_counters &) = delete;
+    perf_counters &operator=(const perf_counters &) = delete;
+
+    void start() {
+        for (int fd : fd_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop() {
+        for (int fd : fd_) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (int i = 0; i < NUM_EVENTS; ++i) {
+            // value, time enabled, time running: scaled if the PMU was multiplexed
+            uint64_t v[3];
+            valid_[i] = fd_[i] >= 0 && read(fd_[i], v, sizeof(v)) == sizeof(v) && v[2] > 0;
+            count_[i] = valid_[i] ? double(v[0]) * v[1] / v[2] : 0.0;
+        }
+    }
+
+    bool valid(event e) const { return valid_[e]; }
+    double count(event e) const { return count_[e]; }
+
+    void print(const char *label, uint64_t elements) const {
+        std::printf("# perf (%s): cycles %s, instructions %s, IPC %s, LLC misses %s",
+                    label, format(count_[CYCLES], valid_[CYCLES]).c_str(),
+                    format(count_[INSTRUCTIONS], valid_[INSTRUCTIONS]).c_str(),
+                    format(count_[INSTRUCTIONS] / count_[CYCLES],
+                           valid_[CYCLES] && valid_[INSTRUCTIONS] && count_[CYCLES] > 0).c_str(),
+                    format(count_[LLC_MISSES], valid_[LLC_MISSES]).c_str());
+        if (elements > 0 && valid_[LLC_MISSES]) {
+            std::printf(" (%.4g per element)", count_[LLC_MISSES] / elements);
+        }
+        std::printf(", vector instructions %s\n", format(count_[VECTOR], valid_[VECTOR]).c_str());
+        std::fflush(stdout);
+    }
+
+private:
+    void open_event(event e, uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fd_[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    static std::string format(double value, bool valid) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.4g", value);
+        return valid ? buf : "n/a";
+    }
+
+    int fd_[NUM_EVENTS];
+    double count_[NUM_EVENTS] = {};
+    bool valid_[NUM_EVENTS] = {};
+};
+
+    #define PERFSTART(label)                                                   \
+        perf_counters perf##label;                                             \
+        perf##label.start();
+
+    #define PERFSTOP(label, elements)                                          \
+        perf##label.stop();                                                    \
+        perf##label.print(#label, elements);
+
+    // As PERFSTOP, printed with a label built at run time (const char *)
+    #define PERFSTOP_NAMED(label, name, elements)                              \
+        perf##label.stop();                                                    \
+        perf##label.print(name, elements);
+
+#else
+    #define PERFSTART(label)
+    #define PERFSTOP(label, elements)
+    #define PERFSTOP_NAMED(label, name, elements)
+#endif
+
+
 #ifdef __CUDACC__
     #define CUERR {                                                            \
         cudaError_t err;                                                       \
@@ -6,6 +6,8 @@
 #include <memory>
 #include <atomic>
 #include <hpc_helpers.hpp>
+#include <collatz_cache.hpp>
+#include <collatz_simd.hpp>
 
 using ull = unsigned long long;
 
@@ -13,6 +15,8 @@ using ull = unsigned long long;
 int num_threads = 16;
 int chunk_size = 1;
 bool dynamic = false;
+ull cache_bound = COLLATZ_CACHE_BOUND;
+bool simd = true;
 
 // Struct for storing Collatz data
 struct CollatzData {
@@ -20,6 +24,7 @@ struct CollatzData {
     std::vector<ull> max_steps_per_range;
     std::mutex max_mutex;
     std::vector<std::unique_ptr<struct DynamicTaskManager>> task_managers; // For dynamic task management
+    std::unique_ptr<CollatzCache> cache; // Steps of the numbers below cache_bound, shared by all threads
 };
 
 // Struct for managing dynamic tasks
@@ -49,28 +54,41 @@ private:
     int chunk_size;
 };
 
-// Function to calculate the number of steps in the Collatz sequence
-ull collatz(ull n) {
-    ull steps = 0;
-    while (n != 1) {
-        n = (n % 2 == 0) ? n / 2 : 3 * n + 1;
-        steps++;
+// Function to count the numbers in all the ranges (elements for PERFSTOP)
+ull count_numbers(const std::vector<std::pair<ull, ull>>& ranges) {
+    ull count = 0;
+    for (const auto& range : ranges) {
+        count += range.second - range.first + 1;
     }
-    return steps;
+    return count;
 }
 
 // Function that implements the dynamic policy
 void dynamic_policy(CollatzData &data) {
+    // Time of every thread, the summary at exit shows the load imbalance
+    SCOPED_TIMER(dynamic_policy_thread);
     ull task_start, task_end;
     ull local_max;
+    CollatzCounters counters;
 
     for (size_t j = 0; j < data.ranges.size(); ++j) {
         local_max = 0;
         
-        // Ask the task manager for the next task
-        while (data.task_managers[j]->get_next_task(task_start, task_end)) {
-            for (ull i = task_start; i <= task_end; ++i) {
-                local_max = std::max(local_max, collatz(i));
+        if (simd) {
+            // The lanes are refilled with the numbers of the tasks, one
+            // task after the other
+            ull i = 1, last = 0;
+            local_max = collatz_max_simd([&](ull &n) {
+                if (i > last && !data.task_managers[j]->get_next_task(i, last)) return false;
+                n = i++;
+                return true;
+            }, *data.cache, counters);
+        } else {
+            // Ask the task manager for the next task
+            while (data.task_managers[j]->get_next_task(task_start, task_end)) {
+                for (ull i = task_start; i <= task_end; ++i) {
+                    local_max = std::max(local_max, data.cache->steps(i, counters));
+                }
             }
         }
 
@@ -80,21 +98,41 @@ void dynamic_policy(CollatzData &data) {
             data.max_steps_per_range[j] = std::max(data.max_steps_per_range[j], local_max);
         }
     }
+    data.cache->add(counters);
 }
 
 // Function that implements the block-cyclic policy
 void block_cyclic_policy(CollatzData &data, int thread_id) {
+    // Time of every thread, the summary at exit shows the load imbalance
+    SCOPED_TIMER(block_cyclic_policy_thread);
     ull start, end;
     ull shift = num_threads * chunk_size;
     ull local_max;
+    CollatzCounters counters;
     for (size_t j = 0; j < data.ranges.size(); ++j) {
         start = data.ranges[j].first;
         end = data.ranges[j].second;
         local_max = 0;
-        // Each thread processes its own chunk of the range
-        for (ull i = start + thread_id * chunk_size; i <= end; i += shift) {
-            for (int k = 0; k < chunk_size && (i + k) <= end; ++k) {
-                local_max = std::max(local_max, collatz(i + k));
+        if (simd) {
+            // The lanes are refilled with the numbers of the chunks of the
+            // thread, in the same order as the scalar loop
+            ull i = start + thread_id * chunk_size;
+            int k = 0;
+            local_max = collatz_max_simd([&](ull &n) {
+                if (k == chunk_size || i + k > end) {
+                    i += shift;
+                    k = 0;
+                }
+                if (i + k > end) return false;
+                n = i + k++;
+                return true;
+            }, *data.cache, counters);
+        } else {
+            // Each thread processes its own chunk of the range
+            for (ull i = start + thread_id * chunk_size; i <= end; i += shift) {
+                for (int k = 0; k < chunk_size && (i + k) <= end; ++k) {
+                    local_max = std::max(local_max, data.cache->steps(i + k, counters));
+                }
             }
         }
         {
@@ -103,6 +141,7 @@ void block_cyclic_policy(CollatzData &data, int thread_id) {
             data.max_steps_per_range[j] = std::max(data.max_steps_per_range[j], local_max);
         }
     }
+    data.cache->add(counters);
 }
 
 // Function to run the Collatz calculation based on the selected policy
@@ -110,6 +149,7 @@ void run(CollatzData &data) {
     std::vector<std::thread> threads;
 
     if (dynamic) {
+        PERFSTART(parallel_collatz_dynamic);
         TIMERSTART(parallel_collatz_dynamic);
 
         // Creation of threads for the dynamic policy
@@ -119,7 +159,9 @@ void run(CollatzData &data) {
         for (auto &t : threads)
             t.join();
         TIMERSTOP(parallel_collatz_dynamic);
+        PERFSTOP(parallel_collatz_dynamic, count_numbers(data.ranges));
     } else {
+        PERFSTART(parallel_collatz_static);
         TIMERSTART(parallel_collatz_static);
 
         // Creation of threads for the block-cyclic policy
@@ -129,6 +171,7 @@ void run(CollatzData &data) {
         for (auto &t : threads)
             t.join();
         TIMERSTOP(parallel_collatz_static);
+        PERFSTOP(parallel_collatz_static, count_numbers(data.ranges));
     }
 }
 
@@ -148,7 +191,7 @@ int main(int argc, char* argv[]) {
     // Check if there are enough arguments
     // argv[0] is the program name, so we start from argv[1]
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " [-d] [-n num_threads] [-c chunk_size] start-end [...]" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [-d] [-s] [-n num_threads] [-c chunk_size] [-m cache_bound] start-end [...]" << std::endl;
         return 1;
     }
 
@@ -157,6 +200,8 @@ int main(int argc, char* argv[]) {
         std::string arg(argv[i]);
         if (arg == "-d") {         //Check for dynamic mode
             dynamic = true;
+        } else if (arg == "-s") {  // Scalar evaluation, one number at a time
+            simd = false;
         } else if (arg == "-n") {  // Number of threads
 
             // Check if the next argument is a number
@@ -175,6 +220,15 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: Missing or invalid value for -c option" << std::endl;
                 return 1;
             }
+        } else if (arg == "-m") { // Bound of the step cache (0 disables it)
+
+            // Check if the next argument is a number
+            if (i + 1 < argc && is_number(argv[i + 1])) {
+                cache_bound = std::stoull(argv[++i]);
+            } else {  // If not, print an error message
+                std::cerr << "Error: Missing or invalid value for -m option" << std::endl;
+                return 1;
+            }
         } else {    // Range input
             size_t dash_pos = arg.find('-');
 
@@ -200,6 +254,7 @@ int main(int argc, char* argv[]) {
     CollatzData data;
     data.ranges = ranges;
     data.max_steps_per_range.resize(ranges.size(), 0);
+    data.cache = std::make_unique<CollatzCache>(cache_bound);
 
     // For dynamic mode, create task managers for each range
     for (const auto &range : ranges) {
@@ -210,6 +265,8 @@ int main(int argc, char* argv[]) {
     std::cout << "Dynamic mode: " << (dynamic ? "ON" : "OFF") << std::endl;
     std::cout << "Number of threads: " << num_threads << std::endl;
     std::cout << "Number of tasks (chunk size): " << chunk_size << std::endl;
+    std::cout << "Cache bound: " << cache_bound << std::endl;
+    std::cout << "Lanes: " << (simd ? COLLATZ_LANES : 1) << std::endl;
     std::cout << "Ranges:" << std::endl;
     for (const auto &range : data.ranges) {
         std::cout << range.first << "-" << range.second << std::endl;
@@ -224,6 +281,8 @@ int main(int argc, char* argv[]) {
                   << data.ranges[i].second
                   << ": Max steps = " << data.max_steps_per_range[i] << std::endl;
     }
+    std::cout << "Cache hit rate: " << 100.0 * data.cache->hit_rate()
+              << "%, steps from the cache: " << 100.0 * data.cache->cached_fraction() << "%" << std::endl;
 
     return 0;
 }
\ No newline at end of file
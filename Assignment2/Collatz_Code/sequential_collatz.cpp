@@ -3,28 +3,33 @@
 #include <string>
 #include <algorithm>
 #include <hpc_helpers.hpp>
+#include <collatz_cache.hpp>
 
 using ull=unsigned long long;
 
-// Function to calculate the number of steps in the Collatz sequence
-ull collatz(ull n) {
-    ull steps=0;
-    while (n != 1) {
-        n = (n % 2 == 0) ? n / 2 : 3 * n + 1;
-        steps++;
+// Function to count the numbers in all the ranges (elements for PERFSTOP)
+ull count_numbers(const std::vector<std::pair<ull, ull>>& ranges) {
+    ull count = 0;
+    for (const auto& range : ranges) {
+        count += range.second - range.first + 1;
     }
+    return count;
+}
 
-    return steps;
+// Function to check if a string is a number
+bool is_number(const std::string& s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit);
 }
 
 int main(int argc, char* argv[]) {
 
     std::vector<std::pair<ull, ull>> ranges;
+    ull cache_bound = COLLATZ_CACHE_BOUND;
 
     // Check if there are enough arguments
     // argv[0] is the program name, so we start from argv[1]
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " start1-end1 start2-end2 ..." << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [-m cache_bound] start1-end1 start2-end2 ..." << std::endl;
         return 1;
     }
 
@@ -32,6 +37,16 @@ int main(int argc, char* argv[]) {
     // Each argument should be in the format start-end
     for (int i = 1; i < argc; ++i) {
         std::string input(argv[i]);
+
+        // Bound of the step cache (0 disables it)
+        if (input == "-m") {
+            if (i + 1 < argc && is_number(argv[i + 1])) {
+                cache_bound = std::stoull(argv[++i]);
+                continue;
+            }
+            std::cerr << "Error: Missing or invalid value for -m option" << std::endl;
+            return 1;
+        }
         size_t dash_pos = input.find('-');
 
         if (dash_pos == std::string::npos) {
@@ -62,8 +77,11 @@ int main(int argc, char* argv[]) {
     }
 
     std::vector<ull> maximum(ranges.size(), 0);
+    CollatzCache cache(cache_bound);
+    CollatzCounters counters;
 
     // Start the timer
+    PERFSTART(sequential_collatz);
     TIMERSTART(sequential_collatz);
 
     int j = 0;
@@ -74,17 +92,21 @@ int main(int argc, char* argv[]) {
 
         for (ull i = start; i <= end; ++i) {
             // Calculate the maximum steps for the current range
-            maximum[j] = std::max(maximum[j], collatz(i));
+            maximum[j] = std::max(maximum[j], cache.steps(i, counters));
         }
         ++j;
     }
 
     TIMERSTOP(sequential_collatz);
+    PERFSTOP(sequential_collatz, count_numbers(ranges));
+    cache.add(counters);
 
     // Print the maximum steps for each range
     for (size_t j = 0; j < ranges.size(); ++j) {
         std::cout << "Range " << ranges[j].first << "-" << ranges[j].second << ": Max steps = " << maximum[j] << std::endl;
     }
+    std::cout << "Cache bound: " << cache_bound << ", hit rate: " << 100.0 * cache.hit_rate()
+              << "%, steps from the cache: " << 100.0 * cache.cached_fraction() << "%" << std::endl;
 
     return 0;
 }
\ No newline at end of file
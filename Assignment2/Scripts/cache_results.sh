@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Bounds of the step cache (0 = no cache) and number of threads
+M_values=(0 1048576 16777216 268435456)
+X_values=(1 4 16)
+
+# Output file
+output_file="cache_results.txt"
+
+# Empty the output file before starting
+> "$output_file"
+
+# Loop through each combination of bound and number of threads
+for M in "${M_values[@]}"; do
+    for X in "${X_values[@]}"; do
+        echo "Running for M=$M, X=$X" >> "$output_file"
+        for i in {1..5}; do
+            ./parallel_collatz -n "$X" -m "$M" 1-1000 10000-1000000 50000000-100000000 >> "$output_file" 2>&1
+            echo "" >> "$output_file"
+        done
+        echo "" >> "$output_file"
+    done
+done
@@ -20,6 +20,7 @@ int main(int argc, char *argv[]) {
     std::vector<std::string> fileList;
 
     // ----------------- start timer -----------------
+    PERFSTART(parallel_miniz);
     TIMERSTART(parallel_miniz);
 
     for (int i = (int)start; i < argc; ++i) {
@@ -109,6 +110,8 @@ int main(int argc, char *argv[]) {
             for (const auto &f : fileList) {
                 #pragma omp task firstprivate(f) shared(success)
                 {
+                    // Time of every file, aggregated over all the tasks
+                    SCOPED_TIMER(parallel_miniz_file);
                     bool r;
 
                     if(COMP) {
@@ -128,6 +131,7 @@ int main(int argc, char *argv[]) {
         }
     }
     TIMERSTOP(parallel_miniz);
+    PERFSTOP(parallel_miniz, 0);
     // ------------------- end timer -----------------
     
     // Final status
@@ -29,6 +29,7 @@ int main(int argc, char *argv[]) {
     if (start<0) return -1;
   
 	bool success = true;
+	PERFSTART(sequential_miniz);
 	TIMERSTART(sequential_miniz);
 	while(argv[start]) {
 		size_t filesize=0;
@@ -40,6 +41,7 @@ int main(int argc, char *argv[]) {
 		start++;
 	}
 	TIMERSTOP(sequential_miniz);
+	PERFSTOP(sequential_miniz, 0);
 	if (!success) {
 		printf("Exiting with (some) Error(s)\n");
 		return -1;
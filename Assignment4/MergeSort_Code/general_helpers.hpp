@@ -6,7 +6,7 @@
 //#include <cstdio>
 #include <iostream>
 #include <cstdlib>
-#include <random>
+#include <random_fill.hpp>
 
 
 // check if the string 's' is a number, otherwise it returns false
@@ -60,12 +60,13 @@ static bool parseLen(const char* in, long long &N) {
 }
 
 
+// Random keys in [0, v.size()], generated in parallel: the key of element i
+// depends only on (seed, i), so the array is the same for any number of threads
 void rand_init_ints(std::vector<Record>& v, int seed = 69420) {
-    std::mt19937 gen(seed);
-    std::uniform_int_distribution<unsigned long> dist(0, v.size());
-    for (size_t i = 0; i < v.size(); ++i) {
-        v[i].key = dist(gen);
-    }
+    const unsigned __int128 range = (unsigned __int128)v.size() + 1;
+    philox_parallel_for_each(seed, 0, v.size(), 0, [&v, range](size_t i, uint32_t x) {
+        v[i].key = (unsigned long)((x * range) >> 32);
+    });
 }
 
 
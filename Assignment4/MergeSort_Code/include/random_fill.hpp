@@ -0,0 +1,171 @@
+#ifndef RANDOM_FILL_HPP
+#define RANDOM_FILL_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <hpc_helpers.hpp>
+#if defined(__x86_64__) && defined(__GNUC__)
+    #include <immintrin.h>
+    #define RANDOM_FILL_AVX2
+#endif
+
+// Counter-based random numbers: Philox4x32-10 (Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3", SC 2011).
+// Element i of the stream of a seed is a pure function of (seed, i), so a
+// buffer can be filled by any number of threads, in any order or chunk by
+// chunk, always with the same values. The elements are produced in batches
+// of 32: batch b encrypts the 8 counters 8b .. 8b+7 with the key seed, and
+// element 32b + 8w + j is the word w of counter 8b + j, so that the AVX2
+// version (one counter per lane, selected at run time) stores whole vectors.
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr size_t PHILOX_BATCH = 32;
+
+// 10 rounds of Philox4x32 on ctr, in place
+inline void philox4x32(uint32_t ctr[4], uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < 10; ++r) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * ctr[0];
+        uint64_t p1 = (uint64_t)PHILOX_M1 * ctr[2];
+        uint32_t c0 = (uint32_t)(p1 >> 32) ^ ctr[1] ^ k0;
+        uint32_t c2 = (uint32_t)(p0 >> 32) ^ ctr[3] ^ k1;
+        ctr[0] = c0;
+        ctr[1] = (uint32_t)p1;
+        ctr[2] = c2;
+        ctr[3] = (uint32_t)p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+// Batches [first, first + count) into out (32 * count words)
+inline void philox_batches_scalar(uint64_t first, size_t count, uint64_t seed, uint32_t *out) {
+    for (size_t b = 0; b < count; ++b) {
+        for (uint32_t j = 0; j < 8; ++j) {
+            uint64_t c = (first + b) * 8 + j;
+            uint32_t ctr[4] = {(uint32_t)c, (uint32_t)(c >> 32), 0, 0};
+            philox4x32(ctr, (uint32_t)seed, (uint32_t)(seed >> 32));
+            for (int w = 0; w < 4; ++w) {
+                out[b * PHILOX_BATCH + 8 * w + j] = ctr[w];
+            }
+        }
+    }
+}
+
+#ifdef RANDOM_FILL_AVX2
+// High and low 32 bits of the products of the lanes of x by m
+__attribute__((target("avx2")))
+inline void philox_mulhilo_avx2(__m256i x, __m256i m, __m256i &hi, __m256i &lo) {
+    __m256i even = _mm256_mul_epu32(x, m);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), m);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// Same as philox_batches_scalar, the 8 counters of a batch in the lanes
+__attribute__((target("avx2")))
+inline void philox_batches_avx2(uint64_t first, size_t count, uint64_t seed, uint32_t *out) {
+    const __m256i m0 = _mm256_set1_epi32(PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi32(PHILOX_M1);
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (size_t b = 0; b < count; ++b) {
+        // 8 * batch is a multiple of 8: adding the lane never carries
+        uint64_t c = (first + b) * 8;
+        __m256i x0 = _mm256_add_epi32(_mm256_set1_epi32((uint32_t)c), lane);
+        __m256i x1 = _mm256_set1_epi32((uint32_t)(c >> 32));
+        __m256i x2 = _mm256_setzero_si256();
+        __m256i x3 = _mm256_setzero_si256();
+        uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+        for (int r = 0; r < 10; ++r) {
+            __m256i hi0, lo0, hi1, lo1;
+            philox_mulhilo_avx2(x0, m0, hi0, lo0);
+            philox_mulhilo_avx2(x2, m1, hi1, lo1);
+            x0 = _mm256_xor_si256(_mm256_xor_si256(hi1, x1), _mm256_set1_epi32(k0));
+            x1 = lo1;
+            x2 = _mm256_xor_si256(_mm256_xor_si256(hi0, x3), _mm256_set1_epi32(k1));
+            x3 = lo0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        __m256i *o = (__m256i *)(out + b * PHILOX_BATCH);
+        _mm256_storeu_si256(o, x0);
+        _mm256_storeu_si256(o + 1, x1);
+        _mm256_storeu_si256(o + 2, x2);
+        _mm256_storeu_si256(o + 3, x3);
+    }
+}
+#endif
+
+inline void philox_batches(uint64_t first, size_t count, uint64_t seed, uint32_t *out) {
+#ifdef RANDOM_FILL_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        philox_batches_avx2(first, count, seed, out);
+        return;
+    }
+#endif
+    philox_batches_scalar(first, count, seed, out);
+}
+
+// Calls f(i, x) for the elements i in [begin, end) of the stream of seed,
+// generated 1024 at a time in a buffer that stays in L1
+template <typename F>
+inline void philox_for_each(uint64_t seed, size_t begin, size_t end, F f) {
+    constexpr size_t CHUNK = 32 * PHILOX_BATCH;
+    alignas(32) uint32_t buf[CHUNK];
+    for (size_t i = begin; i < end;) {
+        uint64_t batch = i / PHILOX_BATCH;
+        size_t offset = i % PHILOX_BATCH;
+        size_t count = std::min(CHUNK / PHILOX_BATCH, (end - batch * PHILOX_BATCH + PHILOX_BATCH - 1) / PHILOX_BATCH);
+        philox_batches(batch, count, seed, buf);
+        size_t n = std::min(count * PHILOX_BATCH - offset, end - i);
+        for (size_t k = 0; k < n; ++k) {
+            f(i + k, buf[offset + k]);
+        }
+        i += n;
+    }
+}
+
+// philox_for_each over [begin, end) split in contiguous blocks among
+// num_threads threads (0 = all the hardware threads); f must be safe to call
+// concurrently for different elements
+template <typename F>
+inline void philox_parallel_for_each(uint64_t seed, size_t begin, size_t end, int num_threads, F f) {
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Below 64k elements per thread, threads cost more than they save
+    size_t n = end - begin;
+    num_threads = (int)std::max<size_t>(1, std::min<size_t>(num_threads, n >> 16));
+    // Whole batches per thread, rounded up so that the blocks cover [begin, end)
+    size_t block = SDIV(SDIV(n, PHILOX_BATCH), (size_t)num_threads) * PHILOX_BATCH;
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        size_t b = begin + std::min(n, t * block), e = begin + std::min(n, (t + 1) * block);
+        threads.emplace_back([=] { philox_for_each(seed, b, e, f); });
+    }
+    philox_for_each(seed, begin, begin + std::min(n, block), f);
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+// Float in [min, max) from the 24 high bits of x
+inline float philox_uniform(uint32_t x, float min, float max) {
+    return min + (max - min) * ((x >> 8) * (1.0f / 16777216.0f));
+}
+
+// out[i] = element first + i of the stream of seed, uniform in [min, max)
+inline void random_fill_uniform(float *out, size_t n, uint64_t seed, float min = -1.0f, float max = 1.0f,
+                                size_t first = 0, int num_threads = 0) {
+    philox_parallel_for_each(seed, first, first + n, num_threads, [=](size_t i, uint32_t x) {
+        out[i - first] = philox_uniform(x, min, max);
+    });
+}
+
+#endif // RANDOM_FILL_HPP
@@ -225,7 +225,10 @@ struct Worker: ff_node_t<Task> {
             size_t right = task->right;
 
             // Sequentially sort the part of the array assigned to this worker
-            mergesort_seq(data, tmp, left, right);
+            {
+                SCOPED_TIMER(worker_sort);
+                mergesort_seq(data, tmp, left, right);
+            }
 
             // Set is_sorted to true to indicate that this part is sorted
             task->is_sorted = true;
@@ -238,7 +241,10 @@ struct Worker: ff_node_t<Task> {
             size_t mid = task->mid;
             size_t right = task->right;
             // Merge the two sorted parts
-            merge(data, tmp, left, mid, right);
+            {
+                SCOPED_TIMER(worker_merge);
+                merge(data, tmp, left, mid, right);
+            }
 
             ff_send_out(task);
             return GO_ON;
@@ -589,9 +595,11 @@ int main(int argc, char* argv[]) {
         std::vector<Record> tmp(SIZE);
         rand_init_ints(data); 
 
+        PERFSTART(parallel_sort);
         TIMERSTART(parallel_sort);
         internal_work(data, tmp); // Run the parallel mergesort
         TIMERSTOP(parallel_sort);
+        PERFSTOP(parallel_sort, SIZE);
         
 
         if (is_sorted_keys(data)) {
@@ -208,7 +208,10 @@ struct Worker: ff_node_t<Task> {
             size_t right = task->right;
 
             // Sequentially sort the part of the array assigned to this worker
-            mergesort_seq(data, tmp, left, right);
+            {
+                SCOPED_TIMER(worker_sort);
+                mergesort_seq(data, tmp, left, right);
+            }
 
             task->is_sorted = true;
 
@@ -221,7 +224,10 @@ struct Worker: ff_node_t<Task> {
             size_t mid = task->mid;
             size_t right = task->right;
             // Merge the two sorted parts
-            merge(data, tmp, left, mid, right);
+            {
+                SCOPED_TIMER(worker_merge);
+                merge(data, tmp, left, mid, right);
+            }
 
             ff_send_out(task);
             return GO_ON;
@@ -256,9 +262,11 @@ int main(int argc, char* argv[]) {
     // If N_THREADS is 1, we run the sequential version of mergesort
     if (N_THREADS == 1) {
 
+        PERFSTART(parallel_sort);
         TIMERSTART(parallel_sort);
         mergesort_seq(data, tmp, 0, SIZE);
         TIMERSTOP(parallel_sort);
+        PERFSTOP(parallel_sort, SIZE);
 
         if (is_sorted_keys(data)) {
             std::cout << "Array sorted correctly.\n";
@@ -284,6 +292,7 @@ int main(int argc, char* argv[]) {
     farm.wrap_around(); // Wrap around to create a feedback channel
     farm.cleanup_workers(); // Enable worker cleanup
 
+    PERFSTART(parallel_sort);
     TIMERSTART(parallel_sort);
 
     // Run the farm and wait for it to finish
@@ -293,6 +302,7 @@ int main(int argc, char* argv[]) {
     }
 
     TIMERSTOP(parallel_sort);
+    PERFSTOP(parallel_sort, SIZE);
 
     // Verification
     if (is_sorted_keys(data)) {
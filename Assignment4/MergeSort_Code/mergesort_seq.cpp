@@ -79,11 +79,13 @@ int main(int argc, char* argv[]) {
     rand_init_ints(data);  
 
 
+    PERFSTART(sequential_mergesort);
     TIMERSTART(sequential_mergesort);
 
     mergesort_seq(data, tmp, 0, SIZE); 
 
     TIMERSTOP(sequential_mergesort);
+    PERFSTOP(sequential_mergesort, SIZE);
 
     if (is_sorted_keys(data)) {
         std::cout << "Array sorted correctly.\n";